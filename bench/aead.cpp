@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2021 by Paul-Louis Ageneau
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bench.hpp"
+#include "impl/aesgcm.hpp"
+#include "impl/chachapoly.hpp"
+#include "impl/cipher.hpp"
+#include "impl/opensslaead.hpp"
+
+#include <vector>
+
+using namespace legio;
+using namespace legio::impl;
+
+namespace {
+
+const std::vector<size_t> PayloadSizes = {64, 256, 1024, 4096, 16384, 65536};
+
+struct AeadProvider {
+	string name;
+	std::function<unique_ptr<AeadEncryption>(CipherSuite suite, binary key)> encryption;
+	std::function<unique_ptr<AeadDecryption>(CipherSuite suite, binary key)> decryption;
+};
+
+} // namespace
+
+void benchAead() {
+	std::vector<AeadProvider> providers;
+	providers.push_back(
+	    {"Crypto++",
+	     [](CipherSuite suite, binary key) -> unique_ptr<AeadEncryption> {
+		     if (suite == CipherSuite::AesGcm)
+			     return std::make_unique<AesGcmEncryption>(std::move(key));
+		     else
+			     return std::make_unique<ChaChaPolyEncryption>(std::move(key));
+	     },
+	     [](CipherSuite suite, binary key) -> unique_ptr<AeadDecryption> {
+		     if (suite == CipherSuite::AesGcm)
+			     return std::make_unique<AesGcmDecryption>(std::move(key));
+		     else
+			     return std::make_unique<ChaChaPolyDecryption>(std::move(key));
+	     }});
+#if LEGIO_USE_OPENSSL
+	providers.push_back({"OpenSSL",
+	                     [](CipherSuite suite, binary key) -> unique_ptr<AeadEncryption> {
+		                     return std::make_unique<OpenSslAeadEncryption>(suite, std::move(key));
+	                     },
+	                     [](CipherSuite suite, binary key) -> unique_ptr<AeadDecryption> {
+		                     return std::make_unique<OpenSslAeadDecryption>(suite, std::move(key));
+	                     }});
+#endif
+
+	const binary ad = RandomBinary(16);
+	for (const auto &provider : providers) {
+		for (auto suite : {CipherSuite::AesGcm, CipherSuite::ChaChaPoly}) {
+			binary key = RandomBinary(32); // as derived by sessions
+			auto encryption = provider.encryption(suite, key);
+			auto decryption = provider.decryption(suite, key);
+
+			for (size_t size : PayloadSizes) {
+				string variant = string(CipherSuiteName(suite)) + " " + provider.name + " " +
+				                 std::to_string(size) + "B";
+
+				binary cleartext = RandomBinary(size);
+				binary ciphertext(size + AeadEncryption::TagSize);
+				run(
+				    "aead-seal", variant,
+				    [&]() {
+					    encryption->resynchronize();
+					    encryption->encrypt(cleartext.data(), size, ciphertext.data(), ad);
+				    },
+				    size);
+
+				encryption->resynchronize();
+				encryption->encrypt(cleartext.data(), size, ciphertext.data(), ad);
+				binary iv = encryption->iv();
+				binary output(ciphertext.size());
+				run(
+				    "aead-open", variant,
+				    [&]() {
+					    decryption->resynchronize(iv);
+					    if (!decryption->decrypt(ciphertext.data(), ciphertext.size(),
+					                             output.data(), ad))
+						    throw std::runtime_error("AEAD authentication failed");
+				    },
+				    size);
+			}
+		}
+	}
+}
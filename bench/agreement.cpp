@@ -0,0 +1,43 @@
+/**
+ * Copyright (C) 2021 by Paul-Louis Ageneau
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bench.hpp"
+#include "impl/ecdh.hpp"
+
+#include <vector>
+
+using namespace legio;
+using namespace legio::impl;
+
+void benchAgreement() {
+#if LEGIO_USE_OPENSSL
+	const string p256Provider = "OpenSSL";
+#else
+	const string p256Provider = "Crypto++";
+#endif
+	std::vector<std::pair<string, KeyType>> types = {{"P-256 " + p256Provider, KeyType::P256},
+	                                                 {"X25519 Crypto++", KeyType::Curve25519}};
+
+	for (const auto &[name, type] : types) {
+		Ecdh local(type);
+		Ecdh remote(type);
+		binary remotePublicKey = remote.publicKey();
+		run("agree", name, [&]() { sink = local.agree(remotePublicKey).size(); });
+	}
+}
@@ -0,0 +1,42 @@
+/**
+ * Copyright (C) 2021 by Paul-Louis Ageneau
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef LEGIO_BENCH_BENCH_H
+#define LEGIO_BENCH_BENCH_H
+
+#include "common.hpp"
+
+#include <functional>
+
+extern volatile size_t sink; // keeps results from being optimized out
+
+legio::binary RandomBinary(size_t size);
+
+// Measure the operation and print a result line, with the throughput if it processes bytes
+void run(const legio::string &name, const legio::string &variant, const std::function<void()> &op,
+         size_t bytes = 0);
+
+void benchAead();
+void benchSignatures();
+void benchAgreement();
+void benchCodecs();
+void benchHashes();
+void benchIdentifiers();
+
+#endif
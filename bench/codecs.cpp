@@ -0,0 +1,170 @@
+/**
+ * Copyright (C) 2021 by Paul-Louis Ageneau
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bench.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+using namespace legio;
+
+namespace {
+
+// Stream-based codecs from before the rewrite, kept as a baseline
+namespace legacy {
+
+string to_hex(const binary &bin) {
+	std::ostringstream oss;
+	for (int i = 0; i < bin.size(); ++i) {
+		oss << std::hex << std::uppercase;
+		oss << std::setfill('0') << std::setw(2);
+		oss << unsigned(uint8_t(bin[i]));
+	}
+	return oss.str();
+}
+
+binary from_hex(const string &str) {
+	binary out;
+	if (str.empty())
+		return out;
+
+	int count = (str.size() + 1) / 2;
+	out.reserve(count);
+	for (int i = 0; i < count; ++i) {
+		std::string s;
+		s += str[i * 2];
+		if (i * 2 + 1 != str.size())
+			s += str[i * 2 + 1];
+		else
+			s += '0';
+
+		unsigned value = 0;
+		std::istringstream iss(s);
+		if (!(iss >> std::hex >> value))
+			throw std::invalid_argument("invalid hexadecimal representation");
+
+		out.push_back(byte(value & 0xFF));
+	}
+
+	return out;
+}
+
+string to_base64(const binary &bin) {
+	static const char *tab = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	string out;
+	out.reserve(4 * ((bin.size() + 2) / 3));
+	int i = 0;
+	while (bin.size() - i >= 3) {
+		auto d0 = to_integer<uint8_t>(bin[i]);
+		auto d1 = to_integer<uint8_t>(bin[i + 1]);
+		auto d2 = to_integer<uint8_t>(bin[i + 2]);
+		out += tab[d0 >> 2];
+		out += tab[((d0 & 3) << 4) | (d1 >> 4)];
+		out += tab[((d1 & 0x0F) << 2) | (d2 >> 6)];
+		out += tab[d2 & 0x3F];
+		i += 3;
+	}
+
+	int left = bin.size() - i;
+	if (left) {
+		auto d0 = to_integer<uint8_t>(bin[i]);
+		out += tab[d0 >> 2];
+		if (left == 1) {
+			out += tab[(d0 & 3) << 4];
+		} else { // left == 2
+			auto d1 = to_integer<uint8_t>(bin[i + 1]);
+			out += tab[((d0 & 3) << 4) | (d1 >> 4)];
+			out += tab[(d1 & 0x0F) << 2];
+		}
+	}
+
+	return out;
+}
+
+binary from_base64(const string &str) {
+	binary out;
+	out.reserve(3 * ((str.size() + 3) / 4));
+	int i = 0;
+	while (i < str.size() && str[i] != '=') {
+		byte tab[4] = {};
+		int j = 0;
+		while (i < str.size() && j < 4) {
+			uint8_t c = str[i];
+			if (c == '=')
+				break;
+
+			if ('A' <= c && c <= 'Z')
+				tab[j] = byte(c - 'A');
+			else if ('a' <= c && c <= 'z')
+				tab[j] = byte(c + 26 - 'a');
+			else if ('0' <= c && c <= '9')
+				tab[j] = byte(c + 52 - '0');
+			else if (c == '+' || c == '-')
+				tab[j] = byte(62);
+			else if (c == '/' || c == '_')
+				tab[j] = byte(63);
+			else
+				throw std::invalid_argument("Invalid character in base64");
+
+			++i;
+			++j;
+		}
+
+		if (j > 0) {
+			out.push_back((tab[0] << 2) | (tab[1] >> 4));
+			if (j > 1) {
+				out.push_back((tab[1] << 4) | (tab[2] >> 2));
+				if (j > 2)
+					out.push_back((tab[2] << 6) | (tab[3]));
+			}
+		}
+	}
+
+	return out;
+}
+
+} // namespace legacy
+
+} // namespace
+
+void benchCodecs() {
+	for (size_t size : {size_t(33), size_t(1024)}) {
+		string suffix = " " + std::to_string(size) + "B";
+		binary bin = RandomBinary(size);
+		string hex = to_hex(bin);
+		string base64 = to_base64(bin);
+
+		run("codec", "to_hex" + suffix, [&]() { sink = to_hex(bin).size(); }, size);
+		run(
+		    "codec", "to_hex previous" + suffix, [&]() { sink = legacy::to_hex(bin).size(); },
+		    size);
+		run("codec", "from_hex" + suffix, [&]() { sink = from_hex(hex).size(); }, size);
+		run(
+		    "codec", "from_hex previous" + suffix, [&]() { sink = legacy::from_hex(hex).size(); },
+		    size);
+		run("codec", "to_base64" + suffix, [&]() { sink = to_base64(bin).size(); }, size);
+		run(
+		    "codec", "to_base64 previous" + suffix,
+		    [&]() { sink = legacy::to_base64(bin).size(); }, size);
+		run("codec", "from_base64" + suffix, [&]() { sink = from_base64(base64).size(); }, size);
+		run(
+		    "codec", "from_base64 previous" + suffix,
+		    [&]() { sink = legacy::from_base64(base64).size(); }, size);
+	}
+}
@@ -0,0 +1,82 @@
+/**
+ * Copyright (C) 2021 by Paul-Louis Ageneau
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bench.hpp"
+#include "impl/identifier.hpp"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+using namespace legio;
+using namespace legio::impl;
+
+namespace {
+
+const size_t IdentifierCount = 10000;
+
+// Previous binary hash, combining the hash of each byte
+struct hash_combine_hash {
+	size_t operator()(const binary &bin) const noexcept {
+		size_t seed = 0;
+		for (const byte b : bin)
+			hash_combine(seed, b);
+		return seed;
+	}
+};
+
+} // namespace
+
+void benchHashes() {
+	for (size_t size : {size_t(Identifier::Size), size_t(1024)}) {
+		string suffix = " " + std::to_string(size) + "B";
+		binary bin = RandomBinary(size);
+		run("hash", "wyhash" + suffix, [&]() { sink = binary_hash()(bin); }, size);
+		run("hash", "hash_combine" + suffix, [&]() { sink = hash_combine_hash()(bin); }, size);
+	}
+}
+
+void benchIdentifiers() {
+	std::vector<Identifier> ids;
+	ids.reserve(IdentifierCount);
+	for (size_t i = 0; i < IdentifierCount; ++i) {
+		binary bin = RandomBinary(Identifier::Size);
+		bin[0] = byte(0xED); // Ed25519 prefix, keys are not materialized
+		ids.emplace_back(bin);
+	}
+
+	std::unordered_map<Identifier, size_t, Identifier::hash> unorderedMap;
+	std::map<Identifier, size_t> orderedMap;
+	std::unordered_map<binary, size_t, hash_combine_hash> binaryMap;
+	std::vector<binary> bins;
+	for (size_t i = 0; i < ids.size(); ++i) {
+		unorderedMap.emplace(ids[i], i);
+		orderedMap.emplace(ids[i], i);
+		bins.emplace_back(ids[i]);
+		binaryMap.emplace(bins.back(), i);
+	}
+
+	size_t i = 0;
+	run("identifier-map", "unordered Identifier",
+	    [&]() { sink = unorderedMap.find(ids[i++ % ids.size()])->second; });
+	run("identifier-map", "ordered Identifier",
+	    [&]() { sink = orderedMap.find(ids[i++ % ids.size()])->second; });
+	run("identifier-map", "unordered binary hash_combine",
+	    [&]() { sink = binaryMap.find(bins[i++ % bins.size()])->second; });
+}
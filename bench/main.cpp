@@ -0,0 +1,95 @@
+/**
+ * Copyright (C) 2021 by Paul-Louis Ageneau
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bench.hpp"
+#include "impl/random.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+using namespace legio;
+using namespace legio::impl;
+
+using std::chrono::steady_clock;
+
+const std::chrono::milliseconds MinDuration(500);
+
+string filter;
+volatile size_t sink;
+
+binary RandomBinary(size_t size) {
+	binary bin(size);
+	Prng().GenerateBlock(reinterpret_cast<CryptoPP::byte *>(bin.data()), bin.size());
+	return bin;
+}
+
+// Run the operation until MinDuration has elapsed, returns the number of operations per second
+double measure(const std::function<void()> &op) {
+	op(); // warm up
+	size_t count = 0;
+	size_t batch = 1;
+	std::chrono::duration<double> elapsed;
+	auto start = steady_clock::now();
+	do {
+		for (size_t i = 0; i < batch; ++i)
+			op();
+
+		count += batch;
+		batch *= 2;
+		elapsed = steady_clock::now() - start;
+	} while (elapsed < MinDuration);
+
+	return double(count) / elapsed.count();
+}
+
+void run(const string &name, const string &variant, const std::function<void()> &op,
+         size_t bytes) {
+	string fullname = name + " " + variant;
+	if (!filter.empty() && fullname.find(filter) == string::npos)
+		return;
+
+	double rate = measure(op);
+	if (bytes > 0)
+		std::printf("%-16s %-32s %12.0f op/s %10.1f MiB/s\n", name.c_str(), variant.c_str(), rate,
+		            rate * double(bytes) / (1024 * 1024));
+	else
+		std::printf("%-16s %-32s %12.0f op/s\n", name.c_str(), variant.c_str(), rate);
+
+	std::fflush(stdout);
+}
+
+int main(int argc, char *argv[]) {
+	try {
+		if (argc > 1)
+			filter = argv[1];
+
+		benchAead();
+		benchSignatures();
+		benchAgreement();
+		benchCodecs();
+		benchHashes();
+		benchIdentifiers();
+		return 0;
+
+	} catch (const std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright (C) 2021 by Paul-Louis Ageneau
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the
+ * Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "bench.hpp"
+#include "impl/ecdsa.hpp"
+#include "impl/ed25519.hpp"
+#include "impl/opensslecdsa.hpp"
+
+#include <vector>
+
+using namespace legio;
+using namespace legio::impl;
+
+namespace {
+
+struct SignatureProvider {
+	string name;
+	shared_ptr<KeyPair> pair;
+	shared_ptr<const PublicKey> publicKey;
+};
+
+} // namespace
+
+void benchSignatures() {
+	const binary message = RandomBinary(256);
+
+	std::vector<SignatureProvider> providers;
+	auto ecdsaPair = std::make_shared<EcdsaPair>();
+	binary ecdsaKey = ecdsaPair->publicPart()->publicKey();
+	providers.push_back({"P-256 Crypto++", ecdsaPair, std::make_shared<EcdsaPublic>(ecdsaKey)});
+	providers.push_back(
+	    {"P-256 Crypto++ precomputed", ecdsaPair, ecdsaPair->publicPart()->precomputed()});
+#if LEGIO_USE_OPENSSL
+	auto opensslPair = std::make_shared<OpenSslEcdsaPair>();
+	binary opensslKey = opensslPair->publicPart()->publicKey();
+	providers.push_back(
+	    {"P-256 OpenSSL", opensslPair, std::make_shared<OpenSslEcdsaPublic>(opensslKey)});
+#endif
+	auto ed25519Pair = std::make_shared<Ed25519Pair>();
+	providers.push_back({"Ed25519 Crypto++", ed25519Pair, ed25519Pair->publicPart()});
+
+	for (const auto &provider : providers) {
+		if (!provider.publicKey)
+			continue;
+
+		run("sign", provider.name, [&]() { sink = provider.pair->sign(message).size(); });
+
+		binary signature = provider.pair->sign(message);
+		run("verify", provider.name, [&]() {
+			if (!provider.publicKey->verify(message, signature))
+				throw std::runtime_error("Signature verification failed");
+		});
+	}
+}
@@ -37,8 +37,34 @@ binary operator^(binary a, const binary &b);
 binary &operator+=(binary &a, const binary &b);
 binary operator+(binary a, const binary &b);
 
+// Non-owning view over contiguous bytes, the viewed data must outlive the view
+class binary_view {
+public:
+	binary_view() = default;
+	binary_view(const byte *data, size_t size) : mData(data), mSize(size) {}
+	binary_view(const binary &bin) : mData(bin.data()), mSize(bin.size()) {}
+
+	const byte *data() const { return mData; }
+	size_t size() const { return mSize; }
+	bool empty() const { return mSize == 0; }
+
+	const byte *begin() const { return mData; }
+	const byte *end() const { return mData + mSize; }
+	const byte &operator[](size_t i) const { return mData[i]; }
+
+	binary_view subview(size_t offset, size_t count = size_t(-1)) const;
+
+private:
+	const byte *mData = nullptr;
+	size_t mSize = 0;
+};
+
+bool operator==(binary_view a, binary_view b);
+bool operator!=(binary_view a, binary_view b);
+
 string to_string(const binary &bin);
 binary to_binary(const string &str);
+binary to_binary(binary_view view);
 
 string to_hex(const binary &bin);
 binary from_hex(const string &str);
@@ -81,45 +107,76 @@ template <size_t C> std::array<string, C> unpack_strings(const binary &bin) {
 	return result;
 }
 
+// Word-at-a-time hash (wyhash), seeded randomly per process against hash flooding
 struct binary_hash {
 	std::size_t operator()(const binary &b) const noexcept;
+	std::size_t operator()(binary_view view) const noexcept;
 };
 
+// Reader parsing in place, the underlying data must outlive the reader
 class binary_reader {
 public:
-	binary_reader(binary bin);
+	binary_reader(binary_view view);
+	binary_reader(binary &&bin) = delete; // would dangle
 
 	size_t read(byte *buffer, size_t size);
 	binary read(size_t size);
+	binary_view readView(size_t size);
 	void readInt(uint8_t &i);
 	void readInt(uint16_t &i);
 	void readInt(uint32_t &i);
 	void readInt(uint64_t &i);
 
 	size_t size() const;
+	size_t position() const;
 	bool finished() const;
 	binary left() const;
+	binary_view leftView() const;
 
 private:
-	binary mBinary;
+	binary_view mView;
 	size_t mPosition;
 };
 
+// Writer appending to a binary, or gathering segments once references are written: written data
+// is then copied in data() while referenced data must outlive the writer, and flatten() copies
+// every segment once into an exactly sized buffer
 class binary_writer {
 public:
+	binary_writer() = default;
+	explicit binary_writer(binary storage); // reuses the capacity of the storage
+
 	void write(const byte *data, size_t size);
 	void write(const binary &data);
+	void write(binary_view data);
 	void writeInt(uint8_t i);
 	void writeInt(uint16_t i);
 	void writeInt(uint32_t i);
 	void writeInt(uint64_t i);
+	void writeRef(binary_view data); // not copied
 
-	size_t size() const;
-	binary &data();
+	size_t size() const;      // including referenced data
+	binary &data();           // written data only, must not be modified once gathering
 	const binary &data() const;
 
+	binary flatten(binary storage = binary()) const; // reuses the capacity of the storage
+	void flatten(byte *out) const;                   // out must hold size() bytes
+
 private:
+	struct Segment {
+		const byte *ref; // nullptr for written data
+		size_t offset;   // in written data
+		size_t size;
+	};
+
+	void addSegment(Segment segment);
+	const Segment &segment(size_t i) const;
+
 	binary mBinary;
+	std::array<Segment, 8> mInlineSegments;
+	std::vector<Segment> mMoreSegments;
+	size_t mSegmentCount = 0; // zero unless gathering
+	size_t mRefSize = 0;
 };
 
 } // namespace legio
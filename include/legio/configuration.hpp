@@ -21,10 +21,19 @@
 
 #include "common.hpp"
 
+#include <chrono>
+
 namespace legio {
 
 const uint16_t DefaultPort = 8080;
 const string DefaultDummyTlsService = "legio-p2p.net";
+const unsigned DefaultVerificationRate = 1000;
+const unsigned DefaultVerificationBurst = 2000;
+
+enum class KeyType {
+	P256,      // ECDSA and ECDH over P-256
+	Curve25519 // Ed25519 and X25519
+};
 
 struct Configuration {
 	optional<uint16_t> port = DefaultPort;
@@ -33,6 +42,14 @@ struct Configuration {
 	optional<string> tlsPemCertificate;
 	optional<string> tlsPemKey;
 	optional<string> dummyTlsService = DefaultDummyTlsService;
+	optional<unsigned> verificationThreads; // defaults to the number of hardware threads
+	optional<unsigned> cryptoThreads;       // for asynchronous sending, same default
+	optional<KeyType> keyType;              // defaults to P256
+	// Incoming messages allowed per second and per link, signed or sealed, 0 for unlimited
+	optional<unsigned> verificationRate;  // defaults to DefaultVerificationRate
+	optional<unsigned> verificationBurst; // defaults to DefaultVerificationBurst
+	// Delay to coalesce small messages per link into batches, disabled if unset
+	optional<std::chrono::microseconds> coalescingDelay;
 };
 
 } // namespace legio
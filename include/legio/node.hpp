@@ -24,6 +24,8 @@
 #include "binary.hpp"
 #include "utils.hpp"
 
+#include <future>
+
 namespace legio {
 
 namespace impl {
@@ -51,7 +53,15 @@ public:
 	// Message API
 	void send(binary id, binary message);
 	void broadcast(binary message);
+	// Send to multiple nodes, the message is encrypted once and split where routes diverge
+	// Returns the nodes whose state is not known yet, to which nothing was sent
+	std::vector<binary> sendMany(std::vector<binary> ids, binary message);
 	void onMessage(std::function<void(binary id, binary message)> callback);
+
+	// Asynchronous message API, encryption and signing run on worker threads
+	// Messages to the same destination are sent in order, calls block while the queue is full
+	std::future<void> sendAsync(binary id, binary message);
+	std::future<void> broadcastAsync(binary message);
 };
 
 } // namespace legio
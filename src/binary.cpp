@@ -21,9 +21,15 @@
 
 #include <algorithm>
 #include <cctype>
-#include <iomanip>
+#include <cstring>
 #include <iostream>
-#include <sstream>
+#include <random>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
 
 namespace legio {
 
@@ -43,6 +49,19 @@ binary &operator+=(binary &a, const binary &b) {
 
 binary operator+(binary a, const binary &b) { return a += b; }
 
+binary_view binary_view::subview(size_t offset, size_t count) const {
+	if (offset > mSize)
+		throw std::out_of_range("subview offset out of bounds");
+
+	return binary_view(mData + offset, std::min(count, mSize - offset));
+}
+
+bool operator==(binary_view a, binary_view b) {
+	return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+bool operator!=(binary_view a, binary_view b) { return !(a == b); }
+
 string to_string(const binary &bin) {
 	string r;
 	r.reserve(bin.size());
@@ -58,120 +77,349 @@ binary to_binary(const string &str) {
 	return r;
 }
 
-string to_hex(const binary &bin) {
-	std::ostringstream oss;
-	for (int i = 0; i < bin.size(); ++i) {
-		oss << std::hex << std::uppercase;
-		oss << std::setfill('0') << std::setw(2);
-		oss << unsigned(uint8_t(bin[i]));
+binary to_binary(binary_view view) { return binary(view.begin(), view.end()); }
+
+namespace {
+
+const char HexDigits[] = "0123456789ABCDEF";
+
+// Reverse lookup table for hex and both base64 alphabets
+const uint8_t Invalid = 0xFF;
+const uint8_t Space = 0xFE;
+
+struct ReverseTable {
+	uint8_t values[256];
+
+	constexpr ReverseTable(const char *alphabet, const char *extra)
+	    : values{} {
+		for (int i = 0; i < 256; ++i)
+			values[i] = Invalid;
+		for (int i = 0; alphabet[i]; ++i)
+			values[uint8_t(alphabet[i])] = uint8_t(i);
+		for (int i = 0; extra[i]; ++i)
+			values[uint8_t(extra[i])] = uint8_t(i + 62);
 	}
-	return oss.str();
+
+	uint8_t operator[](char c) const { return values[uint8_t(c)]; }
+};
+
+constexpr ReverseTable HexTable("0123456789ABCDEF", "");
+constexpr ReverseTable LowerHexTable("0123456789abcdef", "");
+constexpr ReverseTable Base64Table("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+                                   "-_");
+
+inline uint8_t hex_value(char c) {
+	uint8_t v = HexTable[c];
+	if (v == Invalid)
+		v = LowerHexTable[c];
+	if (v == Invalid)
+		throw std::invalid_argument("invalid hexadecimal representation");
+	return v;
 }
 
-binary from_hex(const string &str) {
-	binary out;
-	if (str.empty())
-		return out;
-
-	int count = (str.size() + 1) / 2;
-	out.reserve(count);
-	for (int i = 0; i < count; ++i) {
-		std::string s;
-		s += str[i * 2];
-		if (i * 2 + 1 != str.size())
-			s += str[i * 2 + 1];
-		else
-			s += '0';
-
-		unsigned value = 0;
-		std::istringstream iss(s);
-		if (!(iss >> std::hex >> value))
+// Vectorized kernels processing blocks of 16 bytes, with SSE2 or NEON which are baseline on x86-64
+// and AArch64 so no runtime dispatch is needed, they return the number of bytes processed
+#if defined(__SSE2__)
+
+size_t to_hex_simd(const uint8_t *in, size_t size, char *out) {
+	const __m128i mask = _mm_set1_epi8(0x0F);
+	const __m128i nine = _mm_set1_epi8(9);
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i gap = _mm_set1_epi8('A' - '0' - 10);
+	auto to_chars = [&](__m128i n) {
+		return _mm_add_epi8(_mm_add_epi8(n, zero), _mm_and_si128(_mm_cmpgt_epi8(n, nine), gap));
+	};
+
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+		__m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+		__m128i lo = _mm_and_si128(v, mask);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i),
+		                 to_chars(_mm_unpacklo_epi8(hi, lo)));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2 * i + 16),
+		                 to_chars(_mm_unpackhi_epi8(hi, lo)));
+	}
+	return i;
+}
+
+size_t from_hex_simd(const char *in, size_t count, uint8_t *out) {
+	// Decode 16 characters to 16 nibble values, returns false if any character is invalid
+	auto decode = [](__m128i c, __m128i &values) {
+		__m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+		__m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)),
+		                              _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+		__m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+		                              _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+		values = _mm_or_si128(_mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+		                      _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+		return _mm_movemask_epi8(_mm_or_si128(digit, alpha)) == 0xFFFF;
+	};
+	// Combine pairs of nibbles, the first one of each pair is the high nibble
+	auto combine = [](__m128i values) {
+		__m128i hi = _mm_slli_epi16(_mm_and_si128(values, _mm_set1_epi16(0x00FF)), 4);
+		__m128i lo = _mm_srli_epi16(values, 8);
+		return _mm_or_si128(hi, lo);
+	};
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		__m128i v0, v1;
+		if (!decode(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * i)), v0) ||
+		    !decode(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 2 * i + 16)), v1))
 			throw std::invalid_argument("invalid hexadecimal representation");
 
-		out.push_back(byte(value & 0xFF));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+		                 _mm_packus_epi16(combine(v0), combine(v1)));
 	}
+	return i;
+}
 
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+
+size_t to_hex_simd(const uint8_t *in, size_t size, char *out) {
+	const uint8x16_t nine = vdupq_n_u8(9);
+	const uint8x16_t zero = vdupq_n_u8('0');
+	const uint8x16_t gap = vdupq_n_u8('A' - '0' - 10);
+	auto to_chars = [&](uint8x16_t n) {
+		return vaddq_u8(vaddq_u8(n, zero), vandq_u8(vcgtq_u8(n, nine), gap));
+	};
+
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		uint8x16_t v = vld1q_u8(in + i);
+		uint8x16x2_t chars;
+		chars.val[0] = to_chars(vshrq_n_u8(v, 4));
+		chars.val[1] = to_chars(vandq_u8(v, vdupq_n_u8(0x0F)));
+		vst2q_u8(reinterpret_cast<uint8_t *>(out + 2 * i), chars); // interleaved
+	}
+	return i;
+}
+
+size_t from_hex_simd(const char *in, size_t count, uint8_t *out) {
+	auto decode = [](uint8x16_t c, uint8x16_t &values) {
+		uint8x16_t lower = vorrq_u8(c, vdupq_n_u8(0x20));
+		uint8x16_t digit = vsubq_u8(c, vdupq_n_u8('0'));
+		uint8x16_t alpha = vsubq_u8(lower, vdupq_n_u8('a'));
+		uint8x16_t isDigit = vcltq_u8(digit, vdupq_n_u8(10));
+		uint8x16_t isAlpha = vcltq_u8(alpha, vdupq_n_u8(6));
+		values = vbslq_u8(isDigit, digit, vaddq_u8(alpha, vdupq_n_u8(10)));
+		return vminvq_u8(vorrq_u8(isDigit, isAlpha)) == 0xFF;
+	};
+
+	size_t i = 0;
+	for (; i + 16 <= count; i += 16) {
+		uint8x16x2_t chars = vld2q_u8(reinterpret_cast<const uint8_t *>(in + 2 * i)); // deinterleaved
+		uint8x16_t hi, lo;
+		if (!decode(chars.val[0], hi) || !decode(chars.val[1], lo))
+			throw std::invalid_argument("invalid hexadecimal representation");
+
+		vst1q_u8(out + i, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+	}
+	return i;
+}
+
+#else
+
+size_t to_hex_simd(const uint8_t *, size_t, char *) { return 0; }
+size_t from_hex_simd(const char *, size_t, uint8_t *) { return 0; }
+
+#endif
+
+} // namespace
+
+namespace {
+
+// wyhash, reads are native-endian as hashes are only used within the process
+const uint64_t WySecret[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+                              0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+inline void wymum(uint64_t &a, uint64_t &b) {
+#if defined(__SIZEOF_INT128__)
+	__uint128_t r = __uint128_t(a) * b;
+	a = uint64_t(r);
+	b = uint64_t(r >> 64);
+#else
+	uint64_t ha = a >> 32, hb = b >> 32, la = uint32_t(a), lb = uint32_t(b);
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32);
+	uint64_t c = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+	c += lo < t;
+	a = lo;
+	b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+inline uint64_t wymix(uint64_t a, uint64_t b) {
+	wymum(a, b);
+	return a ^ b;
+}
+
+inline uint64_t wyr8(const uint8_t *p) {
+	uint64_t v;
+	std::memcpy(&v, p, 8);
+	return v;
+}
+
+inline uint64_t wyr4(const uint8_t *p) {
+	uint32_t v;
+	std::memcpy(&v, p, 4);
+	return v;
+}
+
+inline uint64_t wyr3(const uint8_t *p, size_t k) {
+	return (uint64_t(p[0]) << 16) | (uint64_t(p[k >> 1]) << 8) | p[k - 1];
+}
+
+uint64_t wyhash(const uint8_t *p, size_t len, uint64_t seed) {
+	seed ^= wymix(seed ^ WySecret[0], WySecret[1]);
+	uint64_t a, b;
+	if (len <= 16) {
+		if (len >= 4) {
+			a = (wyr4(p) << 32) | wyr4(p + ((len >> 3) << 2));
+			b = (wyr4(p + len - 4) << 32) | wyr4(p + len - 4 - ((len >> 3) << 2));
+		} else if (len > 0) {
+			a = wyr3(p, len);
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		size_t i = len;
+		if (i > 48) {
+			uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = wymix(wyr8(p) ^ WySecret[1], wyr8(p + 8) ^ seed);
+				see1 = wymix(wyr8(p + 16) ^ WySecret[2], wyr8(p + 24) ^ see1);
+				see2 = wymix(wyr8(p + 32) ^ WySecret[3], wyr8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while (i > 16) {
+			seed = wymix(wyr8(p) ^ WySecret[1], wyr8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		a = wyr8(p + i - 16);
+		b = wyr8(p + i - 8);
+	}
+
+	a ^= WySecret[1];
+	b ^= seed;
+	wymum(a, b);
+	return wymix(a ^ WySecret[0] ^ len, b ^ WySecret[1]);
+}
+
+uint64_t HashSeed() {
+	static const uint64_t seed = []() {
+		std::random_device rd;
+		return (uint64_t(rd()) << 32) ^ uint64_t(rd());
+	}();
+	return seed;
+}
+
+} // namespace
+
+string to_hex(const binary &bin) {
+	string out(2 * bin.size(), '\0');
+	auto in = reinterpret_cast<const uint8_t *>(bin.data());
+	for (size_t i = to_hex_simd(in, bin.size(), out.data()); i < bin.size(); ++i) {
+		out[2 * i] = HexDigits[in[i] >> 4];
+		out[2 * i + 1] = HexDigits[in[i] & 0x0F];
+	}
+	return out;
+}
+
+binary from_hex(const string &str) {
+	// An odd trailing digit is the high nibble of the last byte
+	size_t count = (str.size() + 1) / 2;
+	binary out(count);
+	auto o = reinterpret_cast<uint8_t *>(out.data());
+	for (size_t i = from_hex_simd(str.data(), str.size() / 2, o); i < count; ++i) {
+		uint8_t hi = hex_value(str[2 * i]);
+		uint8_t lo = 2 * i + 1 < str.size() ? hex_value(str[2 * i + 1]) : 0;
+		o[i] = (hi << 4) | lo;
+	}
 	return out;
 }
 
 namespace {
 
 string to_base64_impl(const binary &bin, const char *tab, bool padding) {
-	string out;
-	out.reserve(4 * ((bin.size() + 2) / 3));
-	int i = 0;
-	while (bin.size() - i >= 3) {
-		auto d0 = to_integer<uint8_t>(bin[i]);
-		auto d1 = to_integer<uint8_t>(bin[i + 1]);
-		auto d2 = to_integer<uint8_t>(bin[i + 2]);
-		out += tab[d0 >> 2];
-		out += tab[((d0 & 3) << 4) | (d1 >> 4)];
-		out += tab[((d1 & 0x0F) << 2) | (d2 >> 6)];
-		out += tab[d2 & 0x3F];
-		i += 3;
+	size_t full = bin.size() / 3;
+	size_t left = bin.size() % 3;
+	string out(4 * full + (left ? (padding ? 4 : left + 1) : 0), '\0');
+
+	auto in = reinterpret_cast<const uint8_t *>(bin.data());
+	char *o = out.data();
+	for (size_t i = 0; i < full; ++i, in += 3, o += 4) {
+		uint32_t w = (uint32_t(in[0]) << 16) | (uint32_t(in[1]) << 8) | in[2];
+		o[0] = tab[w >> 18];
+		o[1] = tab[(w >> 12) & 0x3F];
+		o[2] = tab[(w >> 6) & 0x3F];
+		o[3] = tab[w & 0x3F];
 	}
 
-	int left = bin.size() - i;
 	if (left) {
-		auto d0 = to_integer<uint8_t>(bin[i]);
-		out += tab[d0 >> 2];
-		if (left == 1) {
-			out += tab[(d0 & 3) << 4];
-			if (padding)
-				out += '=';
-		} else { // left == 2
-			auto d1 = to_integer<uint8_t>(bin[i + 1]);
-			out += tab[((d0 & 3) << 4) | (d1 >> 4)];
-			out += tab[(d1 & 0x0F) << 2];
+		uint32_t w = (uint32_t(in[0]) << 16) | (left == 2 ? uint32_t(in[1]) << 8 : 0);
+		o[0] = tab[w >> 18];
+		o[1] = tab[(w >> 12) & 0x3F];
+		if (left == 2)
+			o[2] = tab[(w >> 6) & 0x3F];
+		if (padding) {
+			o[3] = '=';
+			if (left == 1)
+				o[2] = '=';
 		}
-		if (padding)
-			out += '=';
 	}
 
 	return out;
 }
 
 binary from_base64_impl(const string &str) {
-	binary out;
-	out.reserve(3 * ((str.size() + 3) / 4));
-	int i = 0;
-	while (i < str.size() && str[i] != '=') {
-		byte tab[4] = {};
-		int j = 0;
-		while (i < str.size() && j < 4) {
-			uint8_t c = str[i];
-			if (std::isspace(c))
+	binary out(3 * ((str.size() + 3) / 4));
+	auto o = reinterpret_cast<uint8_t *>(out.data());
+	size_t n = 0;
+
+	// Accumulate sextets in a word, whitespace is skipped and padding ends the input
+	uint32_t w = 0;
+	int j = 0;
+	for (char c : str) {
+		if (c == '=')
+			break;
+
+		uint8_t v = Base64Table[c];
+		if (v == Invalid) {
+			if (std::isspace(uint8_t(c)))
 				continue;
-			if (c == '=')
-				break;
-
-			if ('A' <= c && c <= 'Z')
-				tab[j] = byte(c - 'A');
-			else if ('a' <= c && c <= 'z')
-				tab[j] = byte(c + 26 - 'a');
-			else if ('0' <= c && c <= '9')
-				tab[j] = byte(c + 52 - '0');
-			else if (c == '+' || c == '-')
-				tab[j] = byte(62);
-			else if (c == '/' || c == '_')
-				tab[j] = byte(63);
-			else
-				throw std::invalid_argument("Invalid character in base64");
-
-			++i;
-			++j;
+
+			throw std::invalid_argument("Invalid character in base64");
 		}
 
-		if (j > 0) {
-			out.push_back((tab[0] << 2) | (tab[1] >> 4));
-			if (j > 1) {
-				out.push_back((tab[1] << 4) | (tab[2] >> 2));
-				if (j > 2)
-					out.push_back((tab[2] << 6) | (tab[3]));
-			}
+		w = (w << 6) | v;
+		if (++j == 4) {
+			o[n++] = uint8_t(w >> 16);
+			o[n++] = uint8_t(w >> 8);
+			o[n++] = uint8_t(w);
+			w = 0;
+			j = 0;
 		}
 	}
 
+	if (j == 1)
+		throw std::invalid_argument("Truncated base64");
+
+	if (j > 0) {
+		w <<= 6 * (4 - j);
+		o[n++] = uint8_t(w >> 16);
+		if (j > 2)
+			o[n++] = uint8_t(w >> 8);
+	}
+
+	out.resize(n);
 	return out;
 }
 
@@ -192,28 +440,30 @@ binary from_base64(const string &str) { return from_base64_impl(str); }
 binary from_base64url(const string &str) { return from_base64_impl(str); }
 
 size_t binary_hash::operator()(const binary &bin) const noexcept {
-	size_t seed = 0;
-	for (const byte b : bin)
-		hash_combine(seed, b);
-	return seed;
+	return (*this)(binary_view(bin));
 }
 
-binary_reader::binary_reader(binary bin) : mBinary(std::move(bin)), mPosition(0) {}
+size_t binary_hash::operator()(binary_view view) const noexcept {
+	return size_t(wyhash(reinterpret_cast<const uint8_t *>(view.data()), view.size(), HashSeed()));
+}
 
-size_t binary_reader::read(byte *buffer, size_t size) {
-	if (mPosition + size > mBinary.size())
-		throw std::runtime_error("read out of bounds");
+binary_reader::binary_reader(binary_view view) : mView(view), mPosition(0) {}
 
-	const byte *b = mBinary.data() + mPosition;
-	mPosition += size;
-	std::copy(b, b + size, buffer);
+size_t binary_reader::read(byte *buffer, size_t size) {
+	auto view = readView(size);
+	std::copy(view.begin(), view.end(), buffer);
 	return size;
 }
 
-binary binary_reader::read(size_t size) {
-	binary result(size);
-	read(result.data(), size);
-	return result;
+binary binary_reader::read(size_t size) { return to_binary(readView(size)); }
+
+binary_view binary_reader::readView(size_t size) {
+	if (size > mView.size() - mPosition)
+		throw std::runtime_error("read out of bounds");
+
+	binary_view view(mView.data() + mPosition, size);
+	mPosition += size;
+	return view;
 }
 
 void binary_reader::readInt(uint8_t &i) { read(reinterpret_cast<byte *>(&i), 1); }
@@ -233,17 +483,28 @@ void binary_reader::readInt(uint64_t &i) {
 	i = ntohll(i);
 }
 
-size_t binary_reader::size() const { return mBinary.size() - mPosition; }
+size_t binary_reader::size() const { return mView.size() - mPosition; }
+
+size_t binary_reader::position() const { return mPosition; }
 
-bool binary_reader::finished() const { return mPosition == mBinary.size(); }
+bool binary_reader::finished() const { return mPosition == mView.size(); }
 
-binary binary_reader::left() const { return binary(mBinary.begin() + mPosition, mBinary.end()); }
+binary binary_reader::left() const { return to_binary(leftView()); }
+
+binary_view binary_reader::leftView() const { return mView.subview(mPosition); }
+
+binary_writer::binary_writer(binary storage) : mBinary(std::move(storage)) { mBinary.clear(); }
 
 void binary_writer::write(const byte *data, size_t size) {
+	if (mSegmentCount > 0)
+		addSegment({nullptr, mBinary.size(), size});
+
 	mBinary.insert(mBinary.end(), data, data + size);
 }
 
-void binary_writer::write(const binary &data) { mBinary += data; }
+void binary_writer::write(const binary &data) { write(data.data(), data.size()); }
+
+void binary_writer::write(binary_view data) { write(data.data(), data.size()); }
 
 void binary_writer::writeInt(uint8_t i) { write(reinterpret_cast<const byte *>(&i), 1); }
 
@@ -262,10 +523,75 @@ void binary_writer::writeInt(uint64_t i) {
 	write(reinterpret_cast<const byte *>(&i), 8);
 }
 
-size_t binary_writer::size() const { return mBinary.size(); }
+void binary_writer::writeRef(binary_view data) {
+	if (data.empty())
+		return;
+
+	if (mSegmentCount == 0 && !mBinary.empty())
+		addSegment({nullptr, 0, mBinary.size()}); // start gathering
+
+	addSegment({data.data(), 0, data.size()});
+	mRefSize += data.size();
+}
+
+size_t binary_writer::size() const { return mBinary.size() + mRefSize; }
 
 binary &binary_writer::data() { return mBinary; }
 
 const binary &binary_writer::data() const { return mBinary; }
 
+binary binary_writer::flatten(binary storage) const {
+	storage.clear();
+	storage.reserve(size());
+	if (mSegmentCount == 0) {
+		storage.insert(storage.end(), mBinary.begin(), mBinary.end());
+		return storage;
+	}
+
+	for (size_t i = 0; i < mSegmentCount; ++i) {
+		const Segment &s = segment(i);
+		const byte *data = s.ref ? s.ref : mBinary.data() + s.offset;
+		storage.insert(storage.end(), data, data + s.size);
+	}
+	return storage;
+}
+
+void binary_writer::flatten(byte *out) const {
+	if (mSegmentCount == 0) {
+		std::copy(mBinary.begin(), mBinary.end(), out);
+		return;
+	}
+
+	for (size_t i = 0; i < mSegmentCount; ++i) {
+		const Segment &s = segment(i);
+		const byte *data = s.ref ? s.ref : mBinary.data() + s.offset;
+		out = std::copy(data, data + s.size, out);
+	}
+}
+
+void binary_writer::addSegment(Segment s) {
+	// Merge consecutive written data
+	if (mSegmentCount > 0 && !s.ref) {
+		Segment &last = mSegmentCount <= mInlineSegments.size()
+		                    ? mInlineSegments[mSegmentCount - 1]
+		                    : mMoreSegments.back();
+		if (!last.ref) {
+			last.size += s.size;
+			return;
+		}
+	}
+
+	if (mSegmentCount < mInlineSegments.size())
+		mInlineSegments[mSegmentCount] = s;
+	else
+		mMoreSegments.push_back(s);
+
+	++mSegmentCount;
+}
+
+const binary_writer::Segment &binary_writer::segment(size_t i) const {
+	return i < mInlineSegments.size() ? mInlineSegments[i]
+	                                  : mMoreSegments[i - mInlineSegments.size()];
+}
+
 } // namespace legio
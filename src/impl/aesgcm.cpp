@@ -17,30 +17,33 @@
  */
 
 #include "aesgcm.hpp"
+#include "random.hpp"
 
-#include "cryptopp/filters.h"
-#include "cryptopp/osrng.h"
+#include <cstring>
 
 namespace legio::impl {
 
-const size_t GCM_TAG_SIZE = 16;
+const size_t AesGcmEncryption::NonceSize = 16;
 
-AesGcmEncryption::AesGcmEncryption() : mKey(AES::DEFAULT_KEYLENGTH), mIv(AES::BLOCKSIZE) {
-	CryptoPP::AutoSeededRandomPool prng;
+const size_t IV_COUNTER_SIZE = 8;
+
+AesGcmEncryption::AesGcmEncryption() : mKey(AES::DEFAULT_KEYLENGTH), mIv(NonceSize) {
+	auto &prng = Prng();
 	prng.GenerateBlock(mKey, mKey.size());
-	prng.GenerateBlock(mIv, mIv.size());
+	prng.GenerateBlock(mIv, mIv.size() - IV_COUNTER_SIZE);
+	std::memset(mIv.data() + mIv.size() - IV_COUNTER_SIZE, 0, IV_COUNTER_SIZE);
 
 	mEncryption.SetKeyWithIV(mKey, mKey.size(), mIv, mIv.size());
 }
 
-AesGcmEncryption::AesGcmEncryption(binary key) : mIv(AES::BLOCKSIZE) {
+AesGcmEncryption::AesGcmEncryption(binary key) : mIv(NonceSize) {
 	if (key.size() < AES::BLOCKSIZE)
 		throw std::invalid_argument("AES key too short");
 
 	mKey.Assign(reinterpret_cast<const CryptoPP::byte *>(key.data()), key.size());
 
-	CryptoPP::AutoSeededRandomPool prng;
-	prng.GenerateBlock(mIv, mIv.size());
+	Prng().GenerateBlock(mIv, mIv.size() - IV_COUNTER_SIZE);
+	std::memset(mIv.data() + mIv.size() - IV_COUNTER_SIZE, 0, IV_COUNTER_SIZE);
 
 	mEncryption.SetKeyWithIV(mKey, mKey.size(), mIv, mIv.size());
 }
@@ -57,39 +60,54 @@ binary AesGcmEncryption::iv() const {
 	return binary(b, b + mIv.size());
 }
 
-binary AesGcmEncryption::encrypt(const binary &data) {
-	CryptoPP::ByteQueue queue;
-	CryptoPP::ArraySource source(
-	    reinterpret_cast<const CryptoPP::byte *>(data.data()), data.size(), true,
-	    new CryptoPP::AuthenticatedEncryptionFilter(mEncryption, new CryptoPP::Redirector(queue), false, GCM_TAG_SIZE));
+void AesGcmEncryption::resynchronize() {
+	// The IV is a random prefix chosen with the key followed by a message counter
+	uint64_t counter = htonll(++mCounter);
+	std::memcpy(mIv.data() + mIv.size() - IV_COUNTER_SIZE, &counter, IV_COUNTER_SIZE);
+}
 
-	binary cipher(queue.MaxRetrievable());
-	queue.Get(reinterpret_cast<CryptoPP::byte *>(cipher.data()), cipher.size());
-	return cipher;
+void AesGcmEncryption::encrypt(const byte *data, size_t size, byte *out, binary_view ad) {
+	// EncryptAndAuthenticate resynchronizes with the IV and supports in-place operation
+	auto output = reinterpret_cast<CryptoPP::byte *>(out);
+	mEncryption.EncryptAndAuthenticate(
+	    output, output + size, TagSize, mIv, int(mIv.size()),
+	    reinterpret_cast<const CryptoPP::byte *>(ad.data()), ad.size(),
+	    reinterpret_cast<const CryptoPP::byte *>(data), size);
 }
 
-AesGcmDecryption::AesGcmDecryption(binary key, binary iv) {
+AesGcmDecryption::AesGcmDecryption(binary key) : mIv(AesGcmEncryption::NonceSize) {
 	if (key.size() < AES::BLOCKSIZE)
 		throw std::invalid_argument("AES key too short");
 
-	if (iv.size() < AES::BLOCKSIZE)
-		throw std::invalid_argument("AES IV too short");
-
+	// GCM requires an IV to be set with the key, the actual one is passed on decryption
+	std::memset(mIv.data(), 0, mIv.size());
 	mDecryption.SetKeyWithIV(reinterpret_cast<const CryptoPP::byte *>(key.data()), key.size(),
-	                         reinterpret_cast<const CryptoPP::byte *>(iv.data()), iv.size());
+	                         mIv, mIv.size());
+}
+
+AesGcmDecryption::AesGcmDecryption(binary key, binary iv) : AesGcmDecryption(std::move(key)) {
+	resynchronize(iv);
 }
 
 AesGcmDecryption::~AesGcmDecryption() {}
 
-binary AesGcmDecryption::decrypt(const binary &data) {
-	binary plain(data.size());
-	CryptoPP::ArraySink sink(reinterpret_cast<CryptoPP::byte *>(plain.data()), plain.size());
-	CryptoPP::ArraySource source(
-	    reinterpret_cast<const CryptoPP::byte *>(data.data()), data.size(), true,
-	    new CryptoPP::AuthenticatedEncryptionFilter(mDecryption, new CryptoPP::Redirector(sink), false, GCM_TAG_SIZE));
+void AesGcmDecryption::resynchronize(binary_view iv) {
+	if (iv.size() != AesGcmEncryption::NonceSize)
+		throw std::invalid_argument("Invalid AES-GCM IV size");
+
+	mIv.Assign(reinterpret_cast<const CryptoPP::byte *>(iv.data()), iv.size());
+}
+
+bool AesGcmDecryption::decrypt(const byte *data, size_t size, byte *out, binary_view ad) {
+	if (size < TagSize)
+		return false;
 
-	plain.resize(sink.TotalPutLength());
-	return plain;
+	// DecryptAndVerify resynchronizes with the IV and supports in-place operation
+	size_t length = size - TagSize;
+	auto input = reinterpret_cast<const CryptoPP::byte *>(data);
+	return mDecryption.DecryptAndVerify(
+	    reinterpret_cast<CryptoPP::byte *>(out), input + length, TagSize, mIv, int(mIv.size()),
+	    reinterpret_cast<const CryptoPP::byte *>(ad.data()), ad.size(), input, length);
 }
 
 } // namespace legio::impl
@@ -20,22 +20,31 @@
 #define LEGIO_IMPL_AESGCM_H
 
 #include "common.hpp"
+#include "cipher.hpp"
 
 #include <cryptopp/aes.h>
 #include <cryptopp/gcm.h>
 
 namespace legio::impl {
 
-class AesGcmEncryption {
+// AES-GCM encryption, output is the ciphertext followed by the tag
+class AesGcmEncryption final : public AeadEncryption {
 public:
+	static const size_t NonceSize;
+
 	AesGcmEncryption();
 	AesGcmEncryption(binary key);
 	~AesGcmEncryption();
 
+	CipherSuite suite() const override { return CipherSuite::AesGcm; }
+
 	binary key() const;
-	binary iv() const;
+	binary iv() const override;
 
-	binary encrypt(const binary &data);
+	void resynchronize() override;
+
+	using AeadEncryption::encrypt;
+	void encrypt(const byte *data, size_t size, byte *out, binary_view ad = {}) override;
 
 private:
 	using AES = CryptoPP::AES;
@@ -43,21 +52,30 @@ private:
 	AESGCM::Encryption mEncryption;
 
 	CryptoPP::SecByteBlock mKey, mIv;
+	uint64_t mCounter = 0;
 };
 
-class AesGcmDecryption {
+// AES-GCM decryption, input is the ciphertext followed by the tag
+class AesGcmDecryption final : public AeadDecryption {
 public:
+	AesGcmDecryption(binary key);
 	AesGcmDecryption(binary key, binary iv);
 	~AesGcmDecryption();
 
-	binary decrypt(const binary &data);
+	CipherSuite suite() const override { return CipherSuite::AesGcm; }
+
+	void resynchronize(binary_view iv) override;
+
+	using AeadDecryption::decrypt;
+	bool decrypt(const byte *data, size_t size, byte *out, binary_view ad = {}) override;
 
 private:
 	using AES = CryptoPP::AES;
 	using AESGCM = CryptoPP::GCM<CryptoPP::AES>;
 	AESGCM::Decryption mDecryption;
-};
 
+	CryptoPP::SecByteBlock mIv;
+};
 
 } // namespace legio
 
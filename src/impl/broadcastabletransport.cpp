@@ -28,12 +28,12 @@ BroadcastableTransport::BroadcastableTransport(Node *node, Message::Type type,
 BroadcastableTransport::~BroadcastableTransport() {}
 
 void BroadcastableTransport::broadcast(binary payload) {
-	auto message = make_message(mType, mSendSequence++, std::move(payload), node()->ecdsaPair);
+	auto message = make_message(mType, mSendSequence++, std::move(payload), *node()->keyPair);
 	node()->routing->broadcast(std::move(message));
 }
 
 void BroadcastableTransport::incoming(message_ptr message, shared_ptr<Channel> from) {
-	if (message->destination) {
+	if (message->destination || message->multicast) {
 		Transport::incoming(message, from);
 		return;
 	}
@@ -0,0 +1,179 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "bufferpool.hpp"
+
+#include <algorithm>
+#include <new>
+
+namespace legio::impl {
+
+const size_t MinClassSize = 256;
+const size_t MaxCachedPerClass = 1024;
+const size_t MaxCachedBytes = 16 * 1024 * 1024;
+const size_t BlockGranularity = 16; // at least the fundamental alignment
+const size_t BlocksPerSlab = 64;
+
+namespace {
+
+// Binary whose storage goes back to the pool on destruction
+struct PooledBinary : binary {
+	PooledBinary(binary &&bin) : binary(std::move(bin)) {}
+	~PooledBinary() { BufferPool::Instance().recycle(std::move(*this)); }
+};
+
+} // namespace
+
+BufferPool &BufferPool::Instance() {
+	// Never destroyed, as pooled buffers might still be released during static destruction
+	static BufferPool *instance = new BufferPool();
+	return *instance;
+}
+
+BufferPool::BufferPool() {}
+
+BufferPool::~BufferPool() {}
+
+binary BufferPool::take(size_t capacity) {
+	++mTaken;
+
+	size_t i = 0;
+	while (i < mClasses.size() && (MinClassSize << i) < capacity)
+		++i;
+
+	binary bin;
+	if (i == mClasses.size()) {
+		bin.reserve(capacity); // too large to be pooled
+		return bin;
+	}
+
+	auto &sizeClass = mClasses[i];
+	{
+		std::lock_guard lock(sizeClass.mutex);
+		if (!sizeClass.buffers.empty()) {
+			bin = std::move(sizeClass.buffers.back());
+			sizeClass.buffers.pop_back();
+		}
+	}
+
+	if (bin.capacity() > 0) {
+		++mReused;
+		--mCached;
+		mCachedBytes -= bin.capacity();
+	} else {
+		bin.reserve(MinClassSize << i);
+	}
+	return bin;
+}
+
+binary BufferPool::copy(binary_view view) {
+	if (view.empty())
+		return binary();
+
+	binary bin = take(view.size());
+	bin.insert(bin.end(), view.begin(), view.end());
+	return bin;
+}
+
+void BufferPool::recycle(binary &&bin) {
+	binary discarded(std::move(bin)); // leave the source empty in any case
+	size_t capacity = discarded.capacity();
+	if (capacity < MinClassSize || capacity >= (MinClassSize << mClasses.size()) ||
+	    mCachedBytes.load() + capacity > MaxCachedBytes) {
+		if (capacity > 0)
+			++mDiscarded;
+		return;
+	}
+
+	// Largest class the capacity satisfies
+	size_t i = 0;
+	while (i + 1 < mClasses.size() && (MinClassSize << (i + 1)) <= capacity)
+		++i;
+
+	discarded.clear();
+	auto &sizeClass = mClasses[i];
+	std::lock_guard lock(sizeClass.mutex);
+	if (sizeClass.buffers.size() >= MaxCachedPerClass) {
+		++mDiscarded;
+		return;
+	}
+
+	sizeClass.buffers.push_back(std::move(discarded));
+	++mRecycled;
+	++mCached;
+	mCachedBytes += capacity;
+}
+
+shared_ptr<const binary> BufferPool::share(binary &&bin) {
+	return make_pooled<PooledBinary>(std::move(bin));
+}
+
+void *BufferPool::allocateBlock(size_t size) {
+	size_t i = (std::max(size, size_t(1)) + BlockGranularity - 1) / BlockGranularity - 1;
+	if (i >= mSlabs.size())
+		return ::operator new(size);
+
+	++mBlocks;
+	auto &slab = mSlabs[i];
+	std::lock_guard lock(slab.mutex);
+	if (!slab.free) {
+		// Carve a new slab into blocks of this size
+		size_t blockSize = (i + 1) * BlockGranularity;
+		auto data = static_cast<byte *>(::operator new(blockSize * BlocksPerSlab));
+		mSlabBytes += blockSize * BlocksPerSlab;
+		for (size_t j = 0; j < BlocksPerSlab; ++j) {
+			auto block = reinterpret_cast<FreeBlock *>(data + j * blockSize);
+			block->next = slab.free;
+			slab.free = block;
+		}
+	}
+
+	FreeBlock *block = slab.free;
+	slab.free = block->next;
+	return block;
+}
+
+void BufferPool::deallocateBlock(void *ptr, size_t size) noexcept {
+	size_t i = (std::max(size, size_t(1)) + BlockGranularity - 1) / BlockGranularity - 1;
+	if (i >= mSlabs.size()) {
+		::operator delete(ptr);
+		return;
+	}
+
+	--mBlocks;
+	auto &slab = mSlabs[i];
+	std::lock_guard lock(slab.mutex);
+	auto block = static_cast<FreeBlock *>(ptr);
+	block->next = slab.free;
+	slab.free = block;
+}
+
+BufferPool::Stats BufferPool::stats() const {
+	Stats result;
+	result.taken = mTaken.load();
+	result.reused = mReused.load();
+	result.recycled = mRecycled.load();
+	result.discarded = mDiscarded.load();
+	result.cached = mCached.load();
+	result.cachedBytes = mCachedBytes.load();
+	result.blocks = mBlocks.load();
+	result.slabBytes = mSlabBytes.load();
+	return result;
+}
+
+} // namespace legio::impl
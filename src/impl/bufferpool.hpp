@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_BUFFERPOOL_H
+#define LEGIO_IMPL_BUFFERPOOL_H
+
+#include "common.hpp"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace legio::impl {
+
+// Process-wide pool for the message pipeline, so that steady-state traffic does not hit the heap:
+// binaries are recycled with their capacity in power-of-two size classes, and small fixed-size
+// objects like shared_ptr control blocks and messages are carved out of slabs
+class BufferPool final {
+public:
+	static BufferPool &Instance();
+
+	struct Stats {
+		uint64_t taken = 0;      // binaries handed out
+		uint64_t reused = 0;     // handed out from the pool without allocation
+		uint64_t recycled = 0;   // returned to the pool
+		uint64_t discarded = 0;  // freed because too small, too large, or the class was full
+		size_t cached = 0;       // binaries currently held by the pool
+		size_t cachedBytes = 0;  // capacity currently held by the pool
+		size_t blocks = 0;       // slab blocks currently in use
+		size_t slabBytes = 0;    // memory allocated for slabs, never released
+	};
+
+	// Returns an empty binary with at least the requested capacity
+	binary take(size_t capacity);
+	// Returns a copy of the view in a pooled binary
+	binary copy(binary_view view);
+	// Gives the storage of the binary back to the pool, its capacity is kept for a later take()
+	void recycle(binary &&bin);
+
+	// Shared immutable buffer whose storage is recycled once the last reference is dropped
+	shared_ptr<const binary> share(binary &&bin);
+
+	// Fixed-size blocks from slabs, larger sizes fall back to the heap
+	void *allocateBlock(size_t size);
+	void deallocateBlock(void *ptr, size_t size) noexcept;
+
+	Stats stats() const;
+
+private:
+	BufferPool();
+	~BufferPool();
+
+	struct SizeClass {
+		std::vector<binary> buffers;
+		std::mutex mutex;
+	};
+
+	struct FreeBlock {
+		FreeBlock *next;
+	};
+
+	struct Slab {
+		FreeBlock *free = nullptr;
+		std::mutex mutex;
+	};
+
+	std::array<SizeClass, 10> mClasses; // 256 bytes to 128 KiB
+	std::array<Slab, 32> mSlabs;        // 16 to 512 bytes
+
+	std::atomic<uint64_t> mTaken = 0;
+	std::atomic<uint64_t> mReused = 0;
+	std::atomic<uint64_t> mRecycled = 0;
+	std::atomic<uint64_t> mDiscarded = 0;
+	std::atomic<size_t> mCached = 0;
+	std::atomic<size_t> mCachedBytes = 0;
+	std::atomic<size_t> mBlocks = 0;
+	std::atomic<size_t> mSlabBytes = 0;
+};
+
+// Stateless allocator drawing from the slabs of the buffer pool
+template <typename T> struct PoolAllocator {
+	using value_type = T;
+
+	PoolAllocator() = default;
+	template <typename U> PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+	T *allocate(size_t n) {
+		static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned type");
+		return static_cast<T *>(BufferPool::Instance().allocateBlock(n * sizeof(T)));
+	}
+
+	void deallocate(T *ptr, size_t n) noexcept {
+		BufferPool::Instance().deallocateBlock(ptr, n * sizeof(T));
+	}
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T> &, const PoolAllocator<U> &) {
+	return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T> &, const PoolAllocator<U> &) {
+	return false;
+}
+
+template <typename T, typename... Args> shared_ptr<T> make_pooled(Args &&...args) {
+	return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<Args>(args)...);
+}
+
+} // namespace legio::impl
+
+#endif
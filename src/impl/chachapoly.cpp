@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "chachapoly.hpp"
+#include "random.hpp"
+
+#include <cstring>
+
+namespace legio::impl {
+
+const size_t ChaChaPolyEncryption::KeySize = 32;
+const size_t ChaChaPolyEncryption::NonceSize = 12;
+
+const size_t NONCE_COUNTER_SIZE = 8;
+
+ChaChaPolyEncryption::ChaChaPolyEncryption(binary key) : mIv(NonceSize) {
+	if (key.size() != KeySize)
+		throw std::invalid_argument("Invalid ChaCha20 key size");
+
+	// The nonce is a random prefix chosen with the key followed by a message counter
+	Prng().GenerateBlock(mIv, mIv.size() - NONCE_COUNTER_SIZE);
+	std::memset(mIv.data() + mIv.size() - NONCE_COUNTER_SIZE, 0, NONCE_COUNTER_SIZE);
+
+	mEncryption.SetKeyWithIV(reinterpret_cast<const CryptoPP::byte *>(key.data()), key.size(),
+	                         mIv, mIv.size());
+}
+
+ChaChaPolyEncryption::~ChaChaPolyEncryption() {}
+
+binary ChaChaPolyEncryption::iv() const {
+	auto b = reinterpret_cast<const byte *>(mIv.data());
+	return binary(b, b + mIv.size());
+}
+
+void ChaChaPolyEncryption::resynchronize() {
+	uint64_t counter = htonll(++mCounter);
+	std::memcpy(mIv.data() + mIv.size() - NONCE_COUNTER_SIZE, &counter, NONCE_COUNTER_SIZE);
+}
+
+void ChaChaPolyEncryption::encrypt(const byte *data, size_t size, byte *out, binary_view ad) {
+	auto output = reinterpret_cast<CryptoPP::byte *>(out);
+	mEncryption.EncryptAndAuthenticate(
+	    output, output + size, TagSize, mIv, int(mIv.size()),
+	    reinterpret_cast<const CryptoPP::byte *>(ad.data()), ad.size(),
+	    reinterpret_cast<const CryptoPP::byte *>(data), size);
+}
+
+ChaChaPolyDecryption::ChaChaPolyDecryption(binary key) : mIv(ChaChaPolyEncryption::NonceSize) {
+	if (key.size() != ChaChaPolyEncryption::KeySize)
+		throw std::invalid_argument("Invalid ChaCha20 key size");
+
+	// The actual nonce is passed on decryption
+	std::memset(mIv.data(), 0, mIv.size());
+	mDecryption.SetKeyWithIV(reinterpret_cast<const CryptoPP::byte *>(key.data()), key.size(),
+	                         mIv, mIv.size());
+}
+
+ChaChaPolyDecryption::~ChaChaPolyDecryption() {}
+
+void ChaChaPolyDecryption::resynchronize(binary_view iv) {
+	if (iv.size() != ChaChaPolyEncryption::NonceSize)
+		throw std::invalid_argument("Invalid ChaCha20 nonce size");
+
+	mIv.Assign(reinterpret_cast<const CryptoPP::byte *>(iv.data()), iv.size());
+}
+
+bool ChaChaPolyDecryption::decrypt(const byte *data, size_t size, byte *out, binary_view ad) {
+	if (size < TagSize)
+		return false;
+
+	size_t length = size - TagSize;
+	auto input = reinterpret_cast<const CryptoPP::byte *>(data);
+	return mDecryption.DecryptAndVerify(
+	    reinterpret_cast<CryptoPP::byte *>(out), input + length, TagSize, mIv, int(mIv.size()),
+	    reinterpret_cast<const CryptoPP::byte *>(ad.data()), ad.size(), input, length);
+}
+
+} // namespace legio::impl
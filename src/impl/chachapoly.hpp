@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_CHACHAPOLY_H
+#define LEGIO_IMPL_CHACHAPOLY_H
+
+#include "common.hpp"
+#include "cipher.hpp"
+
+#include <cryptopp/chachapoly.h>
+
+namespace legio::impl {
+
+// ChaCha20-Poly1305 encryption, output is the ciphertext followed by the tag
+class ChaChaPolyEncryption final : public AeadEncryption {
+public:
+	static const size_t KeySize;
+	static const size_t NonceSize;
+
+	ChaChaPolyEncryption(binary key);
+	~ChaChaPolyEncryption();
+
+	CipherSuite suite() const override { return CipherSuite::ChaChaPoly; }
+
+	binary iv() const override;
+
+	void resynchronize() override;
+
+	using AeadEncryption::encrypt;
+	void encrypt(const byte *data, size_t size, byte *out, binary_view ad = {}) override;
+
+private:
+	CryptoPP::ChaCha20Poly1305::Encryption mEncryption;
+
+	CryptoPP::SecByteBlock mIv;
+	uint64_t mCounter = 0;
+};
+
+// ChaCha20-Poly1305 decryption, input is the ciphertext followed by the tag
+class ChaChaPolyDecryption final : public AeadDecryption {
+public:
+	ChaChaPolyDecryption(binary key);
+	~ChaChaPolyDecryption();
+
+	CipherSuite suite() const override { return CipherSuite::ChaChaPoly; }
+
+	void resynchronize(binary_view iv) override;
+
+	using AeadDecryption::decrypt;
+	bool decrypt(const byte *data, size_t size, byte *out, binary_view ad = {}) override;
+
+private:
+	CryptoPP::ChaCha20Poly1305::Decryption mDecryption;
+
+	CryptoPP::SecByteBlock mIv;
+};
+
+} // namespace legio::impl
+
+#endif
@@ -0,0 +1,164 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "cipher.hpp"
+#include "aesgcm.hpp"
+#include "chachapoly.hpp"
+#include "opensslaead.hpp"
+
+#include <cryptopp/cpu.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace legio::impl {
+
+namespace {
+
+bool HasAesHardware() {
+#if defined(__EMSCRIPTEN__)
+	return false;
+#elif CRYPTOPP_BOOL_X86 || CRYPTOPP_BOOL_X32 || CRYPTOPP_BOOL_X64
+	return CryptoPP::HasAESNI() && CryptoPP::HasCLMUL();
+#elif CRYPTOPP_BOOL_ARMV8
+	return CryptoPP::HasAES() && CryptoPP::HasPMULL();
+#else
+	return false;
+#endif
+}
+
+} // namespace
+
+const cipher_suites &LocalCipherSuites() {
+	// Without hardware support, ChaCha20-Poly1305 is several times faster than AES-GCM
+	static const cipher_suites suites =
+	    HasAesHardware() ? cipher_suites{CipherSuite::AesGcm, CipherSuite::ChaChaPoly}
+	                     : cipher_suites{CipherSuite::ChaChaPoly, CipherSuite::AesGcm};
+	return suites;
+}
+
+CipherSuite NegotiateCipherSuite(const cipher_suites &remote) {
+	// Both sides pay for the cipher, so minimize the sum of ranks, ties favor local preference
+	const auto &local = LocalCipherSuites();
+	optional<CipherSuite> result;
+	size_t best = std::numeric_limits<size_t>::max();
+	for (size_t i = 0; i < local.size(); ++i) {
+		auto it = std::find(remote.begin(), remote.end(), local[i]);
+		if (it == remote.end())
+			continue;
+
+		size_t rank = i + size_t(it - remote.begin());
+		if (rank < best) {
+			best = rank;
+			result = local[i];
+		}
+	}
+
+	if (!result)
+		throw std::runtime_error("No common cipher suite");
+
+	return *result;
+}
+
+size_t CipherSuiteNonceSize(CipherSuite suite) {
+	switch (suite) {
+	case CipherSuite::AesGcm:
+		return AesGcmEncryption::NonceSize;
+	case CipherSuite::ChaChaPoly:
+		return ChaChaPolyEncryption::NonceSize;
+	default:
+		throw std::invalid_argument("Unknown cipher suite");
+	}
+}
+
+const char *CipherSuiteName(CipherSuite suite) {
+	switch (suite) {
+	case CipherSuite::AesGcm:
+		return "AES-GCM";
+	case CipherSuite::ChaChaPoly:
+		return "ChaCha20-Poly1305";
+	default:
+		return "unknown";
+	}
+}
+
+const size_t AeadEncryption::TagSize = 16;
+const size_t AeadDecryption::TagSize = AeadEncryption::TagSize;
+
+unique_ptr<AeadEncryption> AeadEncryption::Create(CipherSuite suite, binary key) {
+#if LEGIO_USE_OPENSSL
+	return std::make_unique<OpenSslAeadEncryption>(suite, std::move(key));
+#else
+	switch (suite) {
+	case CipherSuite::AesGcm:
+		return std::make_unique<AesGcmEncryption>(std::move(key));
+	case CipherSuite::ChaChaPoly:
+		return std::make_unique<ChaChaPolyEncryption>(std::move(key));
+	default:
+		throw std::invalid_argument("Unknown cipher suite");
+	}
+#endif
+}
+
+AeadEncryption::~AeadEncryption() {}
+
+binary AeadEncryption::encrypt(binary_view data, binary_view ad) {
+	binary cipher(data.size() + TagSize);
+	encrypt(data.data(), data.size(), cipher.data(), ad);
+	return cipher;
+}
+
+void AeadEncryption::encryptInPlace(binary &data, binary_view ad) {
+	size_t size = data.size();
+	data.resize(size + TagSize);
+	encrypt(data.data(), size, data.data(), ad);
+}
+
+unique_ptr<AeadDecryption> AeadDecryption::Create(CipherSuite suite, binary key) {
+#if LEGIO_USE_OPENSSL
+	return std::make_unique<OpenSslAeadDecryption>(suite, std::move(key));
+#else
+	switch (suite) {
+	case CipherSuite::AesGcm:
+		return std::make_unique<AesGcmDecryption>(std::move(key));
+	case CipherSuite::ChaChaPoly:
+		return std::make_unique<ChaChaPolyDecryption>(std::move(key));
+	default:
+		throw std::invalid_argument("Unknown cipher suite");
+	}
+#endif
+}
+
+AeadDecryption::~AeadDecryption() {}
+
+binary AeadDecryption::decrypt(binary_view data, binary_view ad) {
+	binary plain(data.size() >= TagSize ? data.size() - TagSize : 0);
+	if (!decrypt(data.data(), data.size(), plain.data(), ad))
+		throw std::runtime_error("AEAD authentication failed");
+
+	return plain;
+}
+
+void AeadDecryption::decryptInPlace(binary &data, binary_view ad) {
+	if (!decrypt(data.data(), data.size(), data.data(), ad))
+		throw std::runtime_error("AEAD authentication failed");
+
+	data.resize(data.size() - TagSize);
+}
+
+} // namespace legio::impl
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_CIPHER_H
+#define LEGIO_IMPL_CIPHER_H
+
+#include "common.hpp"
+
+#include <vector>
+
+namespace legio::impl {
+
+// AEAD cipher suites for encrypted payloads, values are sent on the wire
+enum class CipherSuite : uint8_t {
+	AesGcm = 0x01,    // AES-256-GCM
+	ChaChaPoly = 0x02 // ChaCha20-Poly1305
+};
+
+using cipher_suites = std::vector<CipherSuite>;
+
+// Locally supported suites, fastest first for this machine
+const cipher_suites &LocalCipherSuites();
+
+// Pick the suite with the best combined rank in both preference lists, throws if there is none
+CipherSuite NegotiateCipherSuite(const cipher_suites &remote);
+
+size_t CipherSuiteNonceSize(CipherSuite suite);
+const char *CipherSuiteName(CipherSuite suite);
+
+// AEAD encryption, output is the ciphertext followed by the tag
+class AeadEncryption {
+public:
+	static const size_t TagSize;
+
+	static unique_ptr<AeadEncryption> Create(CipherSuite suite, binary key);
+
+	virtual ~AeadEncryption();
+
+	virtual CipherSuite suite() const = 0;
+	virtual binary iv() const = 0;
+
+	// Move to the next IV, keeping the key schedule
+	virtual void resynchronize() = 0;
+
+	// Encrypt size bytes to out, which must hold size + TagSize bytes, out may be equal to data
+	virtual void encrypt(const byte *data, size_t size, byte *out, binary_view ad = {}) = 0;
+	binary encrypt(binary_view data, binary_view ad = {});
+	void encryptInPlace(binary &data, binary_view ad = {});
+};
+
+// AEAD decryption, input is the ciphertext followed by the tag
+class AeadDecryption {
+public:
+	static const size_t TagSize;
+
+	static unique_ptr<AeadDecryption> Create(CipherSuite suite, binary key);
+
+	virtual ~AeadDecryption();
+
+	virtual CipherSuite suite() const = 0;
+
+	// Set the IV of the next message, keeping the key schedule
+	virtual void resynchronize(binary_view iv) = 0;
+
+	// Decrypt size bytes to out, which must hold size - TagSize bytes, out may be equal to data
+	// Returns false if authentication fails
+	virtual bool decrypt(const byte *data, size_t size, byte *out, binary_view ad = {}) = 0;
+	binary decrypt(binary_view data, binary_view ad = {});
+	void decryptInPlace(binary &data, binary_view ad = {});
+};
+
+} // namespace legio::impl
+
+#endif
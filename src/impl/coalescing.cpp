@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "coalescing.hpp"
+#include "bufferpool.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace legio::impl {
+
+const size_t MaxBatchSize = 16 * 1024;         // also bounded by the channel maximum message size
+const size_t MaxCoalescedFrameSize = 4 * 1024; // larger frames are sent as is
+const size_t LengthSize = 2;
+
+Coalescing::Coalescing(Scheduler *scheduler, shared_ptr<Fragmentation> fragmentation,
+                       optional<std::chrono::microseconds> delay)
+    : mScheduler(scheduler), mFragmentation(std::move(fragmentation)), mDelay(delay) {}
+
+Coalescing::~Coalescing() {}
+
+bool Coalescing::IsBatch(binary_view frame) {
+	return !frame.empty() && frame[0] == byte(Message::Batch);
+}
+
+void Coalescing::send(shared_ptr<Channel> channel, binary_view frame) {
+	if (!coalesce(channel, frame))
+		mFragmentation->send(*channel, frame);
+}
+
+void Coalescing::send(shared_ptr<Channel> channel, binary &&frame) {
+	if (!coalesce(channel, frame))
+		mFragmentation->send(*channel, std::move(frame));
+}
+
+bool Coalescing::unpack(binary_view batch,
+                        const std::function<void(binary_view frame)> &callback) {
+	// Check the whole batch first so a malformed one is dropped entirely
+	size_t count = 0;
+	try {
+		binary_reader reader(batch);
+		Header header;
+		reader.read(reinterpret_cast<byte *>(&header), sizeof(header));
+		if (header.type != Message::Batch || header.flags != Message::None ||
+		    ntohs(header.length) != reader.size())
+			throw std::invalid_argument("Invalid batch header");
+
+		while (!reader.finished()) {
+			uint16_t length = 0;
+			reader.readInt(length);
+			auto frame = reader.readView(length);
+			if (frame.empty() || IsBatch(frame) || Fragmentation::IsFragment(frame))
+				throw std::invalid_argument("Invalid frame in batch");
+
+			++count;
+		}
+
+	} catch (const std::exception &) {
+		++mMalformed;
+		return false;
+	}
+
+	binary_reader reader(batch.subview(sizeof(Header)));
+	for (size_t i = 0; i < count; ++i) {
+		uint16_t length = 0;
+		reader.readInt(length);
+		callback(reader.readView(length));
+	}
+
+	mUnpacked += count;
+	return true;
+}
+
+void Coalescing::removeChannel(const Channel *channel) {
+	std::lock_guard lock(mMutex);
+	mLinks.erase(channel); // a pending batch is dropped with the channel
+}
+
+Coalescing::Counters Coalescing::counters() const {
+	Counters result;
+	result.coalesced = mCoalesced.load();
+	result.batches = mBatches.load();
+	result.unpacked = mUnpacked.load();
+	result.malformed = mMalformed.load();
+	return result;
+}
+
+bool Coalescing::coalesce(const shared_ptr<Channel> &channel, binary_view frame) {
+	if (!mDelay)
+		return false;
+
+	auto link = getLink(channel);
+	std::lock_guard lock(link->mutex);
+
+	size_t limit = std::min(MaxBatchSize, channel->maxMessageSize());
+	size_t entrySize = LengthSize + frame.size();
+	if (frame.size() > MaxCoalescedFrameSize || sizeof(Header) + entrySize > limit) {
+		flush(*channel, *link); // keep frames in order
+		return false;
+	}
+
+	if (link->batch.size() + entrySize > limit)
+		flush(*channel, *link);
+
+	if (link->count == 0) {
+		link->batch = BufferPool::Instance().take(limit);
+		link->batch.resize(sizeof(Header)); // written on flush
+	}
+
+	uint16_t length = htons(uint16_t(frame.size()));
+	auto lengthBytes = reinterpret_cast<const byte *>(&length);
+	link->batch.insert(link->batch.end(), lengthBytes, lengthBytes + LengthSize);
+	link->batch.insert(link->batch.end(), frame.begin(), frame.end());
+	++link->count;
+	++mCoalesced;
+
+	if (!link->scheduled) {
+		link->scheduled = true;
+		mScheduler->schedule(*mDelay, [weak_this = weak_from_this(),
+		                               weakChannel = weak_ptr<Channel>(channel),
+		                               weakLink = weak_ptr<Link>(link)]() {
+			if (auto locked = weak_this.lock())
+				locked->flush(weakChannel, weakLink);
+		});
+	}
+
+	return true;
+}
+
+shared_ptr<Coalescing::Link> Coalescing::getLink(const shared_ptr<Channel> &channel) {
+	std::lock_guard lock(mMutex);
+	auto &link = mLinks[channel.get()];
+	if (!link)
+		link = std::make_shared<Link>();
+
+	return link;
+}
+
+void Coalescing::flush(Channel &channel, Link &link) {
+	if (link.count == 0)
+		return;
+
+	binary batch = std::move(link.batch);
+	size_t count = link.count;
+	link.batch = binary();
+	link.count = 0;
+
+	if (count == 1) {
+		// A lone frame is sent as is
+		mFragmentation->send(channel, binary_view(batch).subview(sizeof(Header) + LengthSize));
+		BufferPool::Instance().recycle(std::move(batch));
+		return;
+	}
+
+	Header header;
+	header.type = static_cast<uint8_t>(Message::Batch);
+	header.flags = Message::None;
+	header.length = htons(uint16_t(batch.size() - sizeof(Header)));
+	header.sequence = 0;
+	std::memcpy(batch.data(), &header, sizeof(header));
+
+	++mBatches;
+	mFragmentation->send(channel, std::move(batch));
+}
+
+void Coalescing::flush(weak_ptr<Channel> weakChannel, weak_ptr<Link> weakLink) {
+	auto channel = weakChannel.lock();
+	auto link = weakLink.lock();
+	if (!channel || !link)
+		return;
+
+	std::lock_guard lock(link->mutex);
+	link->scheduled = false;
+	if (channel->isOpen())
+		flush(*channel, *link);
+}
+
+} // namespace legio::impl
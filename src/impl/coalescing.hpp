@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_COALESCING_H
+#define LEGIO_IMPL_COALESCING_H
+
+#include "common.hpp"
+#include "fragmentation.hpp"
+#include "message.hpp"
+#include "scheduler.hpp"
+
+#include <rtc/channel.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+namespace legio::impl {
+
+using rtc::Channel;
+
+// Per-link coalescing of small frames into Batch frames, sent when the next frame would not fit
+// or once the delay has elapsed, to save the per-message overhead of the channel. Batches are
+// link-local, their body is a sequence of frames each preceded by its 16-bit length. Without a
+// delay, frames are sent immediately, but received batches are still unpacked.
+class Coalescing final : public std::enable_shared_from_this<Coalescing> {
+public:
+	Coalescing(Scheduler *scheduler, shared_ptr<Fragmentation> fragmentation,
+	           optional<std::chrono::microseconds> delay);
+	~Coalescing();
+
+	struct Counters {
+		uint64_t coalesced = 0; // frames sent in batches
+		uint64_t batches = 0;   // batches sent
+		uint64_t unpacked = 0;  // frames received in batches
+		uint64_t malformed = 0; // received batches dropped
+	};
+
+	static bool IsBatch(binary_view frame);
+
+	// Frames are sent in order on a channel, whether coalesced or not
+	void send(shared_ptr<Channel> channel, binary_view frame);
+	void send(shared_ptr<Channel> channel, binary &&frame);
+
+	// Calls the callback for each frame, returns false if the batch is malformed
+	bool unpack(binary_view batch, const std::function<void(binary_view frame)> &callback);
+
+	void removeChannel(const Channel *channel);
+
+	Counters counters() const;
+
+private:
+	struct Link {
+		binary batch; // header followed by frames
+		size_t count = 0;
+		bool scheduled = false;
+		std::mutex mutex;
+	};
+
+	bool coalesce(const shared_ptr<Channel> &channel, binary_view frame);
+	shared_ptr<Link> getLink(const shared_ptr<Channel> &channel);
+	void flush(Channel &channel, Link &link);
+	void flush(weak_ptr<Channel> weakChannel, weak_ptr<Link> weakLink);
+
+	Scheduler *const mScheduler;
+	const shared_ptr<Fragmentation> mFragmentation;
+	const optional<std::chrono::microseconds> mDelay;
+
+	std::unordered_map<const Channel *, shared_ptr<Link>> mLinks;
+	std::mutex mMutex;
+
+	std::atomic<uint64_t> mCoalesced = 0;
+	std::atomic<uint64_t> mBatches = 0;
+	std::atomic<uint64_t> mUnpacked = 0;
+	std::atomic<uint64_t> mMalformed = 0;
+};
+
+} // namespace legio::impl
+
+#endif
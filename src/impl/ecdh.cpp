@@ -17,39 +17,142 @@
  */
 
 #include "ecdh.hpp"
-
-#include "cryptopp/osrng.h"
+#include "openssl.hpp"
+#include "random.hpp"
 
 #include <cassert>
 
 namespace legio::impl {
 
-const size_t Ecdh::KeySize = 65;
+const size_t P256_KEY_SIZE = 65;
+const byte P256_PREFIX = byte(0x04); // uncompressed point
+const size_t X25519_KEY_SIZE = 1 + CryptoPP::x25519::PUBLIC_KEYLENGTH;
+const byte X25519_PREFIX = byte(0x25);
+
+size_t Ecdh::KeySize(binary_view encoded) {
+	if (encoded.empty())
+		throw std::invalid_argument("Empty ECDH public key");
+
+	if (encoded[0] == P256_PREFIX)
+		return P256_KEY_SIZE;
+	else if (encoded[0] == X25519_PREFIX)
+		return X25519_KEY_SIZE;
+	else
+		throw std::invalid_argument("Unknown ECDH public key type");
+}
+
+KeyType Ecdh::Type(binary_view encoded) {
+	if (encoded.empty())
+		throw std::invalid_argument("Empty ECDH public key");
+
+	if (encoded[0] == P256_PREFIX)
+		return KeyType::P256;
+	else if (encoded[0] == X25519_PREFIX)
+		return KeyType::Curve25519;
+	else
+		throw std::invalid_argument("Unknown ECDH public key type");
+}
+
+#if LEGIO_USE_OPENSSL
+Ecdh::Ecdh(KeyType type) : mType(type) {
+#else
+Ecdh::Ecdh(KeyType type) : mType(type), mDomain(CryptoPP::ASN1::secp256r1()) {
+#endif
+	auto &prng = Prng();
+	switch (mType) {
+	case KeyType::P256: {
+#if LEGIO_USE_OPENSSL
+		mP256Key = OpenSslGenerateP256();
+		binary point = OpenSslEncodeP256(mP256Key, false);
+		mPublicKey.Assign(reinterpret_cast<const CryptoPP::byte *>(point.data()), point.size());
+#else
+		mPublicKey.New(mDomain.PublicKeyLength());
+		mPrivateKey.New(mDomain.PrivateKeyLength());
+		mDomain.GenerateKeyPair(prng, mPrivateKey, mPublicKey);
+#endif
+		break;
+	}
+	case KeyType::Curve25519:
+		mPublicKey.New(mX25519.PublicKeyLength());
+		mPrivateKey.New(mX25519.PrivateKeyLength());
+		mX25519.GenerateKeyPair(prng, mPrivateKey, mPublicKey);
+		break;
+	default:
+		throw std::invalid_argument("Unknown key type");
+	}
+}
 
-Ecdh::Ecdh(CryptoPP::OID curveId)
-    : mDomain(curveId), mPublicKey(mDomain.PublicKeyLength()),
-      mPrivateKey(mDomain.PrivateKeyLength()) {
-	CryptoPP::AutoSeededRandomPool prng;
-	mDomain.GenerateKeyPair(prng, mPrivateKey, mPublicKey);
+Ecdh::~Ecdh() {
+#if LEGIO_USE_OPENSSL
+	EVP_PKEY_free(mP256Key);
+#endif
 }
 
-Ecdh::~Ecdh() {}
+KeyType Ecdh::type() const { return mType; }
 
 binary Ecdh::publicKey() const {
 	auto b = reinterpret_cast<const byte *>(mPublicKey.data());
-	binary output(b, b + mPublicKey.size());
+	binary output;
+	if (mType == KeyType::Curve25519)
+		output.push_back(X25519_PREFIX);
+
+	output.insert(output.end(), b, b + mPublicKey.size());
 
-	assert(output.size() == KeySize);
+	assert(output.size() == KeySize(output));
 	return output;
 }
 
+#if LEGIO_USE_OPENSSL
+bool Ecdh::agreeP256(const binary &remotePublicKey, CryptoPP::SecByteBlock &secret) const {
+	EVP_PKEY *peer = OpenSslDecodeP256(remotePublicKey);
+	EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new(mP256Key, nullptr);
+	size_t len = 0;
+	bool success = ctx && EVP_PKEY_derive_init(ctx) > 0 &&
+	               EVP_PKEY_derive_set_peer(ctx, peer) > 0 &&
+	               EVP_PKEY_derive(ctx, nullptr, &len) > 0;
+	if (success) {
+		// The shared secret is the x coordinate, as with Crypto++
+		secret.New(len);
+		success = EVP_PKEY_derive(ctx, secret.data(), &len) > 0;
+	}
+
+	EVP_PKEY_CTX_free(ctx);
+	EVP_PKEY_free(peer);
+	return success;
+}
+#endif
+
 binary Ecdh::agree(const binary &remotePublicKey) const {
-	if (remotePublicKey.size() != mDomain.PublicKeyLength())
+	if (remotePublicKey.empty() || remotePublicKey.size() != KeySize(remotePublicKey))
 		throw std::invalid_argument("Invalid remote ECDH public key size");
 
-	CryptoPP::SecByteBlock secret(mDomain.AgreedValueLength());
-	if (!mDomain.Agree(secret, mPrivateKey,
-	                   reinterpret_cast<const CryptoPP::byte *>(remotePublicKey.data())))
+	const auto *remote = reinterpret_cast<const CryptoPP::byte *>(remotePublicKey.data());
+	bool success;
+	CryptoPP::SecByteBlock secret;
+	switch (mType) {
+	case KeyType::P256:
+		if (remotePublicKey[0] != P256_PREFIX)
+			throw std::invalid_argument("Remote ECDH public key type mismatch");
+
+#if LEGIO_USE_OPENSSL
+		success = agreeP256(remotePublicKey, secret);
+#else
+		secret.New(mDomain.AgreedValueLength());
+		success = mDomain.Agree(secret, mPrivateKey, remote);
+#endif
+		break;
+	case KeyType::Curve25519:
+		if (remotePublicKey[0] != X25519_PREFIX)
+			throw std::invalid_argument("Remote ECDH public key type mismatch");
+
+		secret.New(mX25519.AgreedValueLength());
+		success = mX25519.Agree(secret, mPrivateKey, remote + 1); // skip prefix
+		break;
+	default:
+		throw std::logic_error("Unknown key type");
+	}
+
+	if (!success)
 		throw std::runtime_error("Failed to reach ECDH shared secret");
 
 	auto b = reinterpret_cast<const byte *>(secret.data());
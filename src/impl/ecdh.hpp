@@ -20,26 +20,49 @@
 #define LEGIO_IMPL_ECDH_H
 
 #include "common.hpp"
+#include "configuration.hpp" // for KeyType
 
 #include "cryptopp/eccrypto.h"
 #include "cryptopp/oids.h"
+#include "cryptopp/xed25519.h"
+
+#if LEGIO_USE_OPENSSL
+#include <openssl/evp.h>
+#endif
 
 namespace legio::impl {
 
+// Key agreement, with P-256 or X25519 depending on the key type
+// P-256 public keys are encoded as uncompressed points, X25519 ones as a prefix and the key
 class Ecdh final {
 public:
-	static const size_t KeySize;
+	// Size of the encoded public key starting the view, throws if unknown
+	static size_t KeySize(binary_view encoded);
+	// Key type of the encoded public key starting the view, throws if unknown
+	static KeyType Type(binary_view encoded);
 
-	Ecdh(CryptoPP::OID curveId = CryptoPP::ASN1::secp256r1());
+	Ecdh(KeyType type = KeyType::P256);
+	Ecdh(const Ecdh &) = delete;
 	~Ecdh();
 
+	KeyType type() const;
 	binary publicKey() const;
 
 	binary agree(const binary &remotePublicKey) const;
 
 private:
+#if LEGIO_USE_OPENSSL
+	bool agreeP256(const binary &remotePublicKey, CryptoPP::SecByteBlock &secret) const;
+#endif
+
+	const KeyType mType;
+#if LEGIO_USE_OPENSSL
+	EVP_PKEY *mP256Key = nullptr;
+#else
 	CryptoPP::ECDH<CryptoPP::ECP>::Domain mDomain;
-	CryptoPP::SecByteBlock mPublicKey;
+#endif
+	CryptoPP::x25519 mX25519;
+	CryptoPP::SecByteBlock mPublicKey; // without prefix
 	CryptoPP::SecByteBlock mPrivateKey;
 };
 
@@ -17,10 +17,10 @@
  */
 
 #include "ecdsa.hpp"
+#include "random.hpp"
 
 #include "cryptopp/ecp.h"
 #include "cryptopp/oids.h"
-#include "cryptopp/osrng.h"
 #include "cryptopp/queue.h"
 
 #include <cassert>
@@ -29,13 +29,14 @@
 namespace legio::impl {
 
 const size_t EcdsaPublic::KeySize = 33;
+const unsigned EcdsaPublic::DefaultPrecomputationStorage = 16;
 
 EcdsaPublic::EcdsaPublic(CryptoPP::OID curveId) {
 	mPublicKey.AccessGroupParameters().Initialize(curveId);
 	mPublicKey.AccessGroupParameters().SetPointCompression(true);
 }
 
-EcdsaPublic::EcdsaPublic(const binary &key, CryptoPP::OID curveId) : EcdsaPublic(curveId) {
+EcdsaPublic::EcdsaPublic(binary_view key, CryptoPP::OID curveId) : EcdsaPublic(curveId) {
 	const auto &curve = mPublicKey.GetGroupParameters().GetCurve();
 
 	CryptoPP::ECP::Point point;
@@ -43,38 +44,67 @@ EcdsaPublic::EcdsaPublic(const binary &key, CryptoPP::OID curveId) : EcdsaPublic
 	    point, reinterpret_cast<const CryptoPP::byte *>(key.data()), key.size());
 	mPublicKey.SetPublicElement(point);
 
-	CryptoPP::AutoSeededRandomPool prng;
+	auto &prng = Prng();
 	if (!mPublicKey.Validate(prng, 3))
 		throw std::runtime_error("Failed to validate external ECDSA public key");
 }
 
+EcdsaPublic::EcdsaPublic(const ECDSA::PublicKey &publicKey) : mPublicKey(publicKey) {
+	mPublicKey.AccessGroupParameters().SetPointCompression(true);
+}
+
 EcdsaPublic::~EcdsaPublic() {}
 
-binary EcdsaPublic::publicKey() const {
-	const auto &point = mPublicKey.GetPublicElement();
-	const auto &curve = mPublicKey.GetGroupParameters().GetCurve();
+namespace {
+
+binary EncodePoint(const EcdsaPublic::ECDSA::PublicKey &publicKey, bool compressed) {
+	const auto &point = publicKey.GetPublicElement();
+	const auto &curve = publicKey.GetGroupParameters().GetCurve();
 
 	CryptoPP::ByteQueue queue;
-	curve.EncodePoint(queue, point, true); // compressed
+	curve.EncodePoint(queue, point, compressed);
 
 	binary output(queue.MaxRetrievable());
 	queue.Get(reinterpret_cast<CryptoPP::byte *>(output.data()), output.size());
+	return output;
+}
+
+} // namespace
 
+binary EcdsaPublic::publicKey() const {
+	binary output = EncodePoint(mPublicKey, true);
 	assert(output.size() == KeySize);
 	return output;
 }
 
-bool EcdsaPublic::verify(const binary &message, const binary &signature) const {
-	return verify(message.data(), message.size(), signature);
-}
+binary EcdsaPublic::uncompressedPublicKey() const { return EncodePoint(mPublicKey, false); }
+
+bool EcdsaPublic::verify(const byte *message, size_t size, binary_view signature) const {
+	if (mPrecomputedVerifier)
+		return mPrecomputedVerifier->VerifyMessage(
+		    reinterpret_cast<const CryptoPP::byte *>(message), size,
+		    reinterpret_cast<const CryptoPP::byte *>(signature.data()), signature.size());
 
-bool EcdsaPublic::verify(const byte *message, size_t size, const binary &signature) const {
 	ECDSA::Verifier verifier(mPublicKey);
 	return verifier.VerifyMessage(
 	    reinterpret_cast<const CryptoPP::byte *>(message), size,
 	    reinterpret_cast<const CryptoPP::byte *>(signature.data()), signature.size());
 }
 
+void EcdsaPublic::precompute(unsigned storage) {
+	auto verifier = std::make_shared<ECDSA::Verifier>(mPublicKey);
+	verifier->AccessKey().Precompute(storage); // precomputes both the generator and public element
+	mPrecomputedVerifier = std::move(verifier);
+}
+
+bool EcdsaPublic::isPrecomputed() const { return bool(mPrecomputedVerifier); }
+
+shared_ptr<const PublicKey> EcdsaPublic::precomputed() const {
+	auto result = std::make_shared<EcdsaPublic>(*this);
+	result->precompute();
+	return result;
+}
+
 bool EcdsaPublic::operator==(const EcdsaPublic &other) const {
 	return mPublicKey.GetPublicElement() == other.mPublicKey.GetPublicElement();
 }
@@ -92,32 +122,40 @@ bool EcdsaPublic::operator>(const EcdsaPublic &other) const {
 }
 
 std::size_t EcdsaPublic::hash::operator()(const EcdsaPublic &ecdsa) const noexcept {
-	return binary_hash()(ecdsa.publicKey());
+	// Hash the x coordinate in place rather than encoding the point
+	CryptoPP::byte x[32];
+	ecdsa.mPublicKey.GetPublicElement().x.Encode(x, sizeof(x));
+	return binary_hash()(binary_view(reinterpret_cast<const byte *>(x), sizeof(x)));
 }
 
-EcdsaPair::EcdsaPair(CryptoPP::OID curveId) : EcdsaPublic(curveId) {
-	CryptoPP::AutoSeededRandomPool prng;
+EcdsaPair::EcdsaPair(CryptoPP::OID curveId) {
+	auto &prng = Prng();
 	mPrivateKey.Initialize(prng, curveId);
 	if (!mPrivateKey.Validate(prng, 3))
 		throw std::runtime_error("Failed to validate ECDSA private key");
 
-	mPrivateKey.MakePublicKey(mPublicKey);
-	if (!mPublicKey.Validate(prng, 3))
+	ECDSA::PublicKey publicKey;
+	mPrivateKey.MakePublicKey(publicKey);
+	if (!publicKey.Validate(prng, 3))
 		throw std::runtime_error("Failed to validate ECDSA public key");
 
-	mPublicKey.AccessGroupParameters().SetPointCompression(true);
+	mPublic = std::make_shared<const EcdsaPublic>(publicKey);
+
+	mSigner.AccessKey().AssignFrom(mPrivateKey);
+	mSigner.AccessKey().Precompute(); // fixed-base precomputation for the generator
 }
 
 EcdsaPair::~EcdsaPair() {}
 
-binary EcdsaPair::sign(const binary &message) const {
-	CryptoPP::AutoSeededRandomPool prng;
-	ECDSA::Signer signer(mPrivateKey);
-	binary signature(signer.MaxSignatureLength());
-	size_t len =
-	    signer.SignMessage(prng, // signature requires nonce
-	                       reinterpret_cast<const CryptoPP::byte *>(message.data()), message.size(),
-	                       reinterpret_cast<CryptoPP::byte *>(signature.data()));
+shared_ptr<const PublicKey> EcdsaPair::publicPart() const { return mPublic; }
+
+binary EcdsaPair::sign(const byte *message, size_t size) const {
+	// The RFC 6979 signer keeps internal HMAC state, so it must not be used concurrently
+	std::lock_guard lock(mSignerMutex);
+	binary signature(mSigner.MaxSignatureLength());
+	size_t len = mSigner.SignMessage(Prng(), // unused for the nonce, which is deterministic
+	                                 reinterpret_cast<const CryptoPP::byte *>(message), size,
+	                                 reinterpret_cast<CryptoPP::byte *>(signature.data()));
 	signature.resize(len);
 	return signature;
 }
@@ -20,23 +20,38 @@
 #define LEGIO_IMPL_ECDSA_H
 
 #include "common.hpp"
+#include "keys.hpp"
 
 #include "cryptopp/eccrypto.h"
 #include "cryptopp/oids.h"
 
+#include <mutex>
+
 namespace legio::impl {
 
-class EcdsaPublic {
+class EcdsaPublic final : public PublicKey {
 public:
 	static const size_t KeySize;
+	static const unsigned DefaultPrecomputationStorage;
+
+	using ECDSA = CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>;
+
+	EcdsaPublic(binary_view key, CryptoPP::OID curve = CryptoPP::ASN1::secp256r1());
+	EcdsaPublic(const ECDSA::PublicKey &publicKey); // must be already validated
+	~EcdsaPublic();
+
+	KeyType type() const override { return KeyType::P256; }
 
-	EcdsaPublic(const binary &key, CryptoPP::OID curve = CryptoPP::ASN1::secp256r1());
-	virtual ~EcdsaPublic();
+	binary publicKey() const override;
+	binary uncompressedPublicKey() const; // for importing into other libraries
 
-	binary publicKey() const;
+	using PublicKey::verify;
+	bool verify(const byte *message, size_t size, binary_view signature) const override;
 
-	bool verify(const binary &message, const binary &signature) const;
-	bool verify(const byte *message, size_t size, const binary &signature) const;
+	// Precompute tables for the public element to speed up verification, at a memory cost
+	void precompute(unsigned storage = DefaultPrecomputationStorage);
+	bool isPrecomputed() const;
+	shared_ptr<const PublicKey> precomputed() const override;
 
 	bool operator==(const EcdsaPublic &other) const;
 	bool operator!=(const EcdsaPublic &other) const;
@@ -47,22 +62,35 @@ public:
         std::size_t operator()(const EcdsaPublic &ecdsa) const noexcept;
     };
 
-protected:
-	EcdsaPublic(CryptoPP::OID curveId = CryptoPP::ASN1::secp256r1());
+private:
+	EcdsaPublic(CryptoPP::OID curveId);
 
-	using ECDSA = CryptoPP::ECDSA<CryptoPP::ECP, CryptoPP::SHA256>;
 	ECDSA::PublicKey mPublicKey;
+	shared_ptr<const ECDSA::Verifier> mPrecomputedVerifier; // long-lived if precomputed
 };
 
-class EcdsaPair final : public EcdsaPublic {
+class EcdsaPair final : public KeyPair {
 public:
 	EcdsaPair(CryptoPP::OID curveId = CryptoPP::ASN1::secp256r1());
+	EcdsaPair(const EcdsaPair &) = delete;
 	~EcdsaPair();
 
-	binary sign(const binary &message) const;
+	KeyType type() const override { return KeyType::P256; }
+	shared_ptr<const PublicKey> publicPart() const override;
+
+	using KeyPair::sign;
+	binary sign(const byte *message, size_t size) const override;
 
 private:
+	using ECDSA = EcdsaPublic::ECDSA;
+
+	// Deterministic nonces (RFC 6979), signatures are verifiable with a regular ECDSA verifier
+	using ECDSA_RFC6979 = CryptoPP::ECDSA_RFC6979<CryptoPP::ECP, CryptoPP::SHA256>;
+
 	ECDSA::PrivateKey mPrivateKey;
+	shared_ptr<const EcdsaPublic> mPublic;
+	ECDSA_RFC6979::Signer mSigner; // long-lived, with fixed-base precomputation
+	mutable std::mutex mSignerMutex;
 };
 
 } // namespace legio::impl
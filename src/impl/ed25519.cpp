@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "ed25519.hpp"
+#include "random.hpp"
+
+namespace legio::impl {
+
+const size_t Ed25519Public::KeySize = 1 + CryptoPP::ed25519Verifier::PUBLIC_KEYLENGTH;
+const byte Ed25519Public::Prefix = byte(0xED);
+
+namespace {
+
+binary CheckEncoding(binary_view key) {
+	// Only the encoding is checked, there is no point to decompress or validate
+	if (key.size() != Ed25519Public::KeySize || key[0] != Ed25519Public::Prefix)
+		throw std::invalid_argument("Invalid Ed25519 public key");
+
+	return to_binary(key);
+}
+
+} // namespace
+
+Ed25519Public::Ed25519Public(binary_view key)
+    : mKey(CheckEncoding(key)),
+      mVerifier(reinterpret_cast<const CryptoPP::byte *>(mKey.data()) + 1) {}
+
+Ed25519Public::~Ed25519Public() {}
+
+binary Ed25519Public::publicKey() const { return mKey; }
+
+bool Ed25519Public::verify(const byte *message, size_t size, binary_view signature) const {
+	return mVerifier.VerifyMessage(
+	    reinterpret_cast<const CryptoPP::byte *>(message), size,
+	    reinterpret_cast<const CryptoPP::byte *>(signature.data()), signature.size());
+}
+
+Ed25519Pair::Ed25519Pair() : mSigner(Prng()) {
+	auto b = reinterpret_cast<const byte *>(mSigner.GetPrivateKey().GetPublicKeyBytePtr());
+	binary key;
+	key.reserve(Ed25519Public::KeySize);
+	key.push_back(Ed25519Public::Prefix);
+	key.insert(key.end(), b, b + CryptoPP::ed25519Verifier::PUBLIC_KEYLENGTH);
+	mPublic = std::make_shared<const Ed25519Public>(key);
+}
+
+Ed25519Pair::~Ed25519Pair() {}
+
+shared_ptr<const PublicKey> Ed25519Pair::publicPart() const { return mPublic; }
+
+binary Ed25519Pair::sign(const byte *message, size_t size) const {
+	// Ed25519 signatures are deterministic and the signer holds no state, no lock is needed
+	binary signature(mSigner.MaxSignatureLength());
+	size_t len = mSigner.SignMessage(Prng(), reinterpret_cast<const CryptoPP::byte *>(message),
+	                                 size, reinterpret_cast<CryptoPP::byte *>(signature.data()));
+	signature.resize(len);
+	return signature;
+}
+
+} // namespace legio::impl
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_ED25519_H
+#define LEGIO_IMPL_ED25519_H
+
+#include "common.hpp"
+#include "keys.hpp"
+
+#include "cryptopp/xed25519.h"
+
+namespace legio::impl {
+
+// Ed25519 public key, encoded as a type prefix followed by the 32-byte key
+class Ed25519Public final : public PublicKey {
+public:
+	static const size_t KeySize; // with prefix
+	static const byte Prefix;
+
+	Ed25519Public(binary_view key);
+	~Ed25519Public();
+
+	KeyType type() const override { return KeyType::Curve25519; }
+
+	binary publicKey() const override;
+
+	using PublicKey::verify;
+	bool verify(const byte *message, size_t size, binary_view signature) const override;
+
+private:
+	binary mKey;
+	CryptoPP::ed25519Verifier mVerifier;
+};
+
+class Ed25519Pair final : public KeyPair {
+public:
+	Ed25519Pair();
+	Ed25519Pair(const Ed25519Pair &) = delete;
+	~Ed25519Pair();
+
+	KeyType type() const override { return KeyType::Curve25519; }
+	shared_ptr<const PublicKey> publicPart() const override;
+
+	using KeyPair::sign;
+	binary sign(const byte *message, size_t size) const override;
+
+private:
+	CryptoPP::ed25519Signer mSigner;
+	shared_ptr<const Ed25519Public> mPublic;
+};
+
+} // namespace legio::impl
+
+#endif
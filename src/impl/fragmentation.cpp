@@ -0,0 +1,202 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "fragmentation.hpp"
+#include "bufferpool.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace legio::impl {
+
+// Reassembly limits per link
+const size_t MaxPartialFrames = 8;
+const size_t MaxBufferedSize = 32 * 1024 * 1024;
+const std::chrono::seconds ReassemblyTimeout(10);
+const size_t InitialReassemblyCapacity = 64 * 1024; // then grown as fragments arrive
+
+const size_t FragmentHeaderSize = 8; // total size and offset
+
+const size_t Fragmentation::MaxFrameSize = Message::MaxBodySize + 1024;
+
+Fragmentation::Fragmentation() {}
+
+Fragmentation::~Fragmentation() {}
+
+bool Fragmentation::IsFragment(binary_view frame) {
+	return !frame.empty() && frame[0] == byte(Message::Fragment);
+}
+
+void Fragmentation::send(Channel &channel, binary_view frame) {
+	size_t maxSize = channel.maxMessageSize();
+	if (frame.size() <= maxSize) {
+		channel.send(frame.data(), frame.size());
+		return;
+	}
+
+	const size_t overhead = sizeof(Header) + FragmentHeaderSize;
+	if (maxSize <= overhead)
+		throw std::runtime_error("Channel maximum message size is too small");
+
+	// The fragment body must also fit the 16-bit length of the header
+	size_t chunkSize = std::min(maxSize - overhead,
+	                            size_t(std::numeric_limits<uint16_t>::max()) - FragmentHeaderSize);
+
+	uint32_t id = mNextId++;
+	++mFragmented;
+
+	auto &pool = BufferPool::Instance();
+	for (size_t offset = 0; offset < frame.size(); offset += chunkSize) {
+		size_t size = std::min(chunkSize, frame.size() - offset);
+
+		Header header;
+		header.type = static_cast<uint8_t>(Message::Fragment);
+		header.flags = Message::None;
+		header.length = htons(uint16_t(FragmentHeaderSize + size));
+		header.sequence = htonl(id);
+
+		binary_writer writer(pool.take(overhead + size));
+		writer.write(reinterpret_cast<const byte *>(&header), sizeof(header));
+		writer.writeInt(uint32_t(frame.size()));
+		writer.writeInt(uint32_t(offset));
+		writer.write(frame.subview(offset, size));
+		channel.send(std::move(writer.data()));
+	}
+}
+
+void Fragmentation::send(Channel &channel, binary &&frame) {
+	if (frame.size() <= channel.maxMessageSize())
+		channel.send(std::move(frame));
+	else
+		send(channel, binary_view(frame));
+}
+
+optional<binary> Fragmentation::reassemble(const Channel *from, binary_view fragment) {
+	++mFragments;
+
+	Header header;
+	uint32_t total = 0;
+	uint32_t offset = 0;
+	binary_view data;
+	try {
+		binary_reader reader(fragment);
+		reader.read(reinterpret_cast<byte *>(&header), sizeof(header));
+		reader.readInt(total);
+		reader.readInt(offset);
+		data = reader.leftView();
+
+		if (header.type != Message::Fragment || header.flags != Message::None ||
+		    ntohs(header.length) != FragmentHeaderSize + data.size() || data.empty() ||
+		    total > MaxFrameSize || offset + data.size() > total)
+			throw std::invalid_argument("Invalid fragment");
+
+	} catch (const std::exception &) {
+		++mDropped;
+		return nullopt;
+	}
+
+	uint32_t id = ntohl(header.sequence);
+	auto now = clock::now();
+
+	std::lock_guard lock(mMutex);
+	auto &link = mLinks[from];
+	expire(link, now);
+
+	auto it = std::find_if(link.partials.begin(), link.partials.end(),
+	                       [id](const Partial &partial) { return partial.id == id; });
+	if (it == link.partials.end()) {
+		if (offset != 0) {
+			++mDropped; // the beginning is missing
+			return nullopt;
+		}
+
+		// Make room, the oldest partial frames are dropped first
+		while (!link.partials.empty() && (link.partials.size() >= MaxPartialFrames ||
+		                                  link.buffered + total > MaxBufferedSize))
+			drop(link, link.partials.begin());
+
+		// The announced total is only trusted for limits, not to allocate up front
+		binary buffer =
+		    BufferPool::Instance().take(std::min(size_t(total), InitialReassemblyCapacity));
+		it = link.partials.insert(link.partials.end(), Partial{id, total, std::move(buffer), now});
+		link.buffered += total;
+	}
+
+	if (it->total != total || it->data.size() != offset) {
+		drop(link, it); // inconsistent or out of order
+		return nullopt;
+	}
+
+	it->data.insert(it->data.end(), data.begin(), data.end());
+	if (it->data.size() < it->total)
+		return nullopt;
+
+	binary frame = std::move(it->data);
+	link.buffered -= it->total;
+	link.partials.erase(it);
+	++mReassembled;
+	return frame;
+}
+
+void Fragmentation::expire() {
+	auto now = clock::now();
+	std::lock_guard lock(mMutex);
+	auto it = mLinks.begin();
+	while (it != mLinks.end()) {
+		expire(it->second, now);
+		if (it->second.partials.empty())
+			it = mLinks.erase(it);
+		else
+			++it;
+	}
+}
+
+void Fragmentation::removeChannel(const Channel *channel) {
+	std::lock_guard lock(mMutex);
+	mLinks.erase(channel);
+}
+
+Fragmentation::Counters Fragmentation::counters() const {
+	Counters result;
+	result.fragmented = mFragmented.load();
+	result.fragments = mFragments.load();
+	result.reassembled = mReassembled.load();
+	result.dropped = mDropped.load();
+	result.expired = mExpired.load();
+	return result;
+}
+
+void Fragmentation::drop(Link &link, std::list<Partial>::iterator it) {
+	++mDropped;
+	link.buffered -= it->total;
+	BufferPool::Instance().recycle(std::move(it->data));
+	link.partials.erase(it);
+}
+
+void Fragmentation::expire(Link &link, clock::time_point now) {
+	// Partial frames are timed from their first fragment
+	while (!link.partials.empty() && now - link.partials.front().time > ReassemblyTimeout) {
+		auto &partial = link.partials.front();
+		++mExpired;
+		link.buffered -= partial.total;
+		BufferPool::Instance().recycle(std::move(partial.data));
+		link.partials.pop_front();
+	}
+}
+
+} // namespace legio::impl
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_FRAGMENTATION_H
+#define LEGIO_IMPL_FRAGMENTATION_H
+
+#include "common.hpp"
+#include "message.hpp"
+
+#include <rtc/channel.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace legio::impl {
+
+using rtc::Channel;
+
+// Hop-by-hop fragmentation of frames larger than the maximum message size of a channel, so a
+// logical message is signed or encrypted once whatever its size. Fragments are Fragment frames
+// without source nor signature, the sequence identifies the frame on the link and the body holds
+// the total frame size and the fragment offset followed by the data. Channels are ordered, so
+// fragments of a frame are expected in order.
+class Fragmentation final {
+public:
+	static const size_t MaxFrameSize;
+
+	Fragmentation();
+	~Fragmentation();
+
+	struct Counters {
+		uint64_t fragmented = 0;  // frames sent in fragments
+		uint64_t fragments = 0;   // fragments received
+		uint64_t reassembled = 0; // frames reassembled
+		uint64_t dropped = 0;     // partial frames dropped as invalid or over limits
+		uint64_t expired = 0;     // partial frames dropped on timeout
+	};
+
+	static bool IsFragment(binary_view frame);
+
+	// Send the frame, in fragments if it is larger than the maximum message size of the channel
+	void send(Channel &channel, binary_view frame);
+	void send(Channel &channel, binary &&frame);
+
+	// Returns the frame once all its fragments have been received
+	optional<binary> reassemble(const Channel *from, binary_view fragment);
+
+	void expire();
+	void removeChannel(const Channel *channel);
+
+	Counters counters() const;
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	struct Partial {
+		uint32_t id;
+		size_t total;
+		binary data;
+		clock::time_point time;
+	};
+
+	struct Link {
+		std::list<Partial> partials; // oldest first
+		size_t buffered = 0;         // sum of the total sizes of partial frames
+	};
+
+	void drop(Link &link, std::list<Partial>::iterator it);
+	void expire(Link &link, clock::time_point now);
+
+	std::unordered_map<const Channel *, Link> mLinks;
+	std::mutex mMutex;
+
+	std::atomic<uint32_t> mNextId = 0;
+
+	std::atomic<uint64_t> mFragmented = 0;
+	std::atomic<uint64_t> mFragments = 0;
+	std::atomic<uint64_t> mReassembled = 0;
+	std::atomic<uint64_t> mDropped = 0;
+	std::atomic<uint64_t> mExpired = 0;
+};
+
+} // namespace legio::impl
+
+#endif
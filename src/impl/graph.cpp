@@ -27,13 +27,83 @@
 
 namespace legio::impl {
 
-Graph::Graph(Node *node) : Component(node), mRoutingTable(std::make_shared<RoutingTable>()) {
-	insert(State(node->ecdsaPair, mStateSequence - 1, mEcdh.publicKey()));
+namespace {
+
+KeyType OtherKeyType(KeyType type) {
+	return type == KeyType::P256 ? KeyType::Curve25519 : KeyType::P256;
+}
+
+} // namespace
+
+Graph::Graph(Node *node)
+    : Component(node), mRoutingTable(std::make_shared<RoutingTable>()),
+      mEcdh(node->keyPair->type()), mOtherEcdh(OtherKeyType(node->keyPair->type())) {
+	insert(State(node->id(), mStateSequence - 1, localEcdhPublicKeys()));
 }
 
 Graph::~Graph() {}
 
-Ecdh Graph::localEcdhPair() const { return mEcdh; }
+std::vector<binary> Graph::localEcdhPublicKeys() const {
+	return {mEcdh.publicKey(), mOtherEcdh.publicKey()};
+}
+
+bool Graph::isLocalEcdhPublicKey(const binary &key) const {
+	return key == mEcdh.publicKey() || key == mOtherEcdh.publicKey();
+}
+
+std::vector<binary> Graph::remoteEcdhPublicKeys(const Identifier &remoteId) const {
+	std::shared_lock lock(mMutex);
+	auto vertice = findVertice(remoteId);
+	if (!vertice || !vertice->state)
+		throw std::runtime_error("Unknown node state");
+
+	return vertice->state->ecdhPublicKeys;
+}
+
+optional<cipher_suites> Graph::remoteCipherSuites(const Identifier &remoteId) const {
+	std::shared_lock lock(mMutex);
+	auto vertice = findVertice(remoteId);
+	if (!vertice || !vertice->state)
+		return nullopt;
+
+	return vertice->state->ciphers;
+}
+
+shared_ptr<Session> Graph::session(const Identifier &remoteId) {
+	binary remoteEcdhPublicKey;
+	CipherSuite suite;
+	{
+		std::shared_lock lock(mMutex);
+		auto vertice = findVertice(remoteId);
+		if (!vertice)
+			throw std::runtime_error("Attempted to get session for unknown node");
+
+		if (!vertice->state)
+			throw std::runtime_error("Unknown node state");
+
+		const auto &keys = vertice->state->ecdhPublicKeys;
+		for (const auto *ecdh : {&mEcdh, &mOtherEcdh}) {
+			auto it = std::find_if(keys.begin(), keys.end(), [ecdh](const binary &key) {
+				return Ecdh::Type(key) == ecdh->type();
+			});
+			if (it != keys.end()) {
+				remoteEcdhPublicKey = *it;
+				break;
+			}
+		}
+
+		if (remoteEcdhPublicKey.empty())
+			throw std::runtime_error("No ECDH public key in common with remote node");
+
+		suite = NegotiateCipherSuite(vertice->state->ciphers);
+	}
+
+	return session(remoteEcdhPublicKey, suite);
+}
+
+shared_ptr<Session> Graph::session(const binary &remoteEcdhPublicKey, CipherSuite suite) {
+	return mSessions.get(localEcdh(Ecdh::Type(remoteEcdhPublicKey)), remoteEcdhPublicKey, suite);
+}
 
 void Graph::update() {
 	std::unique_lock lock(mMutex);
@@ -117,21 +187,25 @@ shared_ptr<RoutingTable> Graph::routingTable() const {
 }
 
 void Graph::broadcastHello() {
-	auto message = make_message(Message::Hello, mHelloSequence++, binary(), node()->ecdsaPair);
+	auto message = make_message(Message::Hello, mHelloSequence++, binary(), *node()->keyPair);
 	node()->routing->broadcast(std::move(message));
 }
 
 void Graph::broadcastState() {
-	State localState(node()->id(), mStateSequence++, mEcdh.publicKey());
+	State localState(node()->id(), mStateSequence++, localEcdhPublicKeys());
 	auto neighbors = node()->routing->neighbors();
 	for (const auto &id : neighbors)
 		localState.neighbors.insert(id);
 
-	auto message = localState.toMessage(node()->ecdsaPair);
+	auto message = localState.toMessage(*node()->keyPair);
 	updateVertice(std::move(localState));
 	node()->routing->broadcast(std::move(message));
 }
 
+const Ecdh &Graph::localEcdh(KeyType type) const {
+	return mEcdh.type() == type ? mEcdh : mOtherEcdh;
+}
+
 shared_ptr<Graph::Vertice> Graph::findVertice(const Identifier &id) const {
 	// mMutex needs to be locked
 
@@ -148,8 +222,13 @@ bool Graph::updateVertice(State state) {
 		if (vertice->state && compare_sequence(state.sequence, vertice->state->sequence) <= 0)
 			return false;
 
-		if (!vertice->state || vertice->state->ecdhPublic != state.ecdhPublic)
+		if (!vertice->state || vertice->state->ecdhPublicKeys != state.ecdhPublicKeys) {
+			if (vertice->state)
+				for (const auto &key : vertice->state->ecdhPublicKeys)
+					mSessions.invalidate(key);
+
 			broadcastState(); // TODO: request broadcast method to limit rate
+		}
 
 		vertice->state = std::move(state);
 
@@ -24,6 +24,7 @@
 #include "state.hpp"
 #include "routing.hpp"
 #include "routingtable.hpp"
+#include "session.hpp"
 
 #include <shared_mutex>
 #include <unordered_map>
@@ -39,7 +40,21 @@ public:
 	void update() override;
 	void notify(const events::variant &event) override;
 
-	Ecdh localEcdhPair() const;
+	// ECDH public keys of the local node, one per key type so nodes of both types can communicate
+	std::vector<binary> localEcdhPublicKeys() const;
+	bool isLocalEcdhPublicKey(const binary &key) const;
+	// ECDH public keys advertised in the signed state of a remote node, by order of preference,
+	// throws if it is unknown
+	std::vector<binary> remoteEcdhPublicKeys(const Identifier &remoteId) const;
+	// Cipher suites advertised in the state of a remote node, nullopt if it is unknown
+	optional<cipher_suites> remoteCipherSuites(const Identifier &remoteId) const;
+
+	// Encryption session with a remote node, throws if its state is unknown
+	// The cipher suite is negotiated from the suites advertised in its state. The ECDH key type is
+	// the node key type when the remote node advertises it, otherwise the other type.
+	shared_ptr<Session> session(const Identifier &remoteId);
+	// Encryption session with a remote ECDH public key, using the local key of the same type
+	shared_ptr<Session> session(const binary &remoteEcdhPublicKey, CipherSuite suite);
 
 	bool insert(State state);
 	const State get(Identifier nodeId) const;
@@ -76,7 +91,11 @@ private:
 	shared_ptr<RoutingTable> mRoutingTable;
 	std::unordered_map<Identifier, shared_ptr<Vertice>, Identifier::hash> mVertices;
 
-	Ecdh mEcdh;
+	const Ecdh &localEcdh(KeyType type) const;
+
+	const Ecdh mEcdh;      // of the node key type, preferred
+	const Ecdh mOtherEcdh; // of the other key type
+	SessionCache mSessions;
 
 	uint32_t mHelloSequence = 0;
 	uint32_t mStateSequence = 0;
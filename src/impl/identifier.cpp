@@ -17,37 +17,65 @@
  */
 
 #include "identifier.hpp"
+#include "keycache.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 namespace legio::impl {
 
-const size_t Identifier::Size = 33;
+Identifier::Identifier(const binary &bin) : Identifier(binary_view(bin)) {}
 
-Identifier::Identifier(const binary &bin) : mPublicKey(bin) {}
+Identifier::Identifier(binary_view view) {
+	if (view.size() != Size)
+		throw std::invalid_argument("Invalid identifier size");
 
-Identifier::Identifier(EcdsaPublic publicKey) : mPublicKey(std::move(publicKey)) {}
+	// Cheap sanity check, full validation happens when the key is materialized
+	// Compressed P-256 points start with 0x02 or 0x03, Ed25519 keys with 0xED
+	if (view[0] != byte(0x02) && view[0] != byte(0x03) && view[0] != byte(0xED))
+		throw std::invalid_argument("Invalid identifier encoding");
 
-Identifier::~Identifier() {}
+	std::copy(view.begin(), view.end(), mBytes.begin());
+	computeHash();
+}
 
-Identifier::operator binary() const {
-	binary bin(mPublicKey.publicKey());
+Identifier::Identifier(shared_ptr<const PublicKey> publicKey) {
+	binary bin = publicKey->publicKey();
 	assert(bin.size() == Size);
-	return bin;
+	std::copy(bin.begin(), bin.end(), mBytes.begin());
+	computeHash();
+
+	// The key is known to be valid, intern it
+	auto &cache = KeyCache::Instance();
+	if (!cache.contains(view()))
+		cache.insert(std::move(publicKey));
 }
 
-Identifier::operator EcdsaPublic() const { return mPublicKey; }
+Identifier::Identifier(const KeyPair &keyPair) : Identifier(keyPair.publicPart()) {}
+
+Identifier::operator binary() const { return binary(mBytes.begin(), mBytes.end()); }
+
+binary_view Identifier::view() const { return binary_view(mBytes.data(), mBytes.size()); }
 
-bool Identifier::operator==(const Identifier &other) const { return mPublicKey == other.mPublicKey; }
+shared_ptr<const PublicKey> Identifier::publicKey() const {
+	return KeyCache::Instance().get(view());
+}
 
-bool Identifier::operator!=(const Identifier &other) const { return mPublicKey != other.mPublicKey; }
+bool Identifier::operator==(const Identifier &other) const {
+	return mHash == other.mHash && std::memcmp(mBytes.data(), other.mBytes.data(), Size) == 0;
+}
 
-bool Identifier::operator<(const Identifier &other) const { return mPublicKey < other.mPublicKey; }
+bool Identifier::operator!=(const Identifier &other) const { return !(*this == other); }
 
-bool Identifier::operator>(const Identifier &other) const { return mPublicKey > other.mPublicKey; }
+bool Identifier::operator<(const Identifier &other) const {
+	return std::memcmp(mBytes.data(), other.mBytes.data(), Size) < 0;
+}
 
-std::size_t Identifier::hash::operator()(const Identifier &id) const noexcept {
-	return binary_hash()(binary(id));
+bool Identifier::operator>(const Identifier &other) const {
+	return std::memcmp(mBytes.data(), other.mBytes.data(), Size) > 0;
 }
 
+void Identifier::computeHash() { mHash = binary_hash()(view()); }
+
 } // namespace legio::impl
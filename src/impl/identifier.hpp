@@ -20,20 +20,28 @@
 #define LEGIO_IMPL_IDENTIFIER_H
 
 #include "common.hpp"
-#include "ecdsa.hpp"
+#include "keys.hpp"
+
+#include <array>
+#include <type_traits>
 
 namespace legio::impl {
 
+// Compact identifier holding the compressed public key encoding, the key itself is materialized
+// from the key cache only when a signature has to be checked
 class Identifier final {
 public:
-	static const size_t Size;
+	static constexpr size_t Size = 33;
 
 	Identifier(const binary &bin);
-	Identifier(EcdsaPublic publicKey);
-	~Identifier();
+	Identifier(binary_view view);
+	Identifier(shared_ptr<const PublicKey> publicKey);
+	Identifier(const KeyPair &keyPair);
 
 	operator binary() const;
-	operator EcdsaPublic() const;
+
+	binary_view view() const;
+	shared_ptr<const PublicKey> publicKey() const;
 
 	bool operator==(const Identifier &other) const;
 	bool operator!=(const Identifier &other) const;
@@ -41,13 +49,18 @@ public:
 	bool operator>(const Identifier &other) const;
 
 	struct hash {
-        std::size_t operator()(const Identifier &id) const noexcept;
-    };
+		std::size_t operator()(const Identifier &id) const noexcept { return id.mHash; }
+	};
 
 private:
-	EcdsaPublic mPublicKey;
+	void computeHash();
+
+	std::array<byte, Size> mBytes;
+	size_t mHash;
 };
 
+static_assert(std::is_trivially_copyable_v<Identifier>, "Identifier must be trivially copyable");
+
 } // namespace legio
 
 #endif
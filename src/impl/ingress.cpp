@@ -0,0 +1,220 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "ingress.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+namespace legio::impl {
+
+// An evicted window restarts at the next accepted sequence, so keep enough for all active sources
+const size_t MaxSequenceWindows = 65536;
+
+Ingress::Ingress(unsigned verificationRate, unsigned verificationBurst)
+    : mVerificationRate(verificationRate),
+      mVerificationBurst(std::max(verificationBurst, 1u)) {}
+
+Ingress::~Ingress() {}
+
+optional<Message::Envelope> Ingress::peek(binary_view bin) {
+	++mReceived;
+	try {
+		auto envelope = Message::Peek(bin);
+		if (!envelope.source)
+			throw std::invalid_argument("Missing message source");
+
+		return envelope;
+
+	} catch (const std::exception &) {
+		++mMalformed;
+		return nullopt;
+	}
+}
+
+bool Ingress::filter(const Message::Envelope &envelope, const Channel *from) {
+	if (!filterType(envelope)) {
+		++mFiltered;
+		return false;
+	}
+
+	if (!checkSequence(envelope)) {
+		++mDuplicate;
+		return false;
+	}
+
+	if (!checkRate(envelope, from)) {
+		++mLimited;
+		return false;
+	}
+
+	return true;
+}
+
+bool Ingress::filterTransit(const Message::Envelope &envelope, const Channel *from) {
+	if (!filterType(envelope)) {
+		++mFiltered;
+		return false;
+	}
+
+	if (!checkRate(envelope, from)) {
+		++mLimited;
+		return false;
+	}
+
+	++mTransit;
+	return true;
+}
+
+message_ptr Ingress::verify(shared_ptr<const binary> wire, const Message::Envelope &envelope) {
+	if (!envelope.verify()) {
+		++mInvalid;
+		return nullptr;
+	}
+
+	return accept(std::move(wire), envelope);
+}
+
+void Ingress::verifyAsync(shared_ptr<const binary> wire, const Message::Envelope &envelope,
+                          VerifyCallback callback) {
+	// The envelope views point into the wire, which the callback keeps alive
+	envelope.verifyAsync([weak_this = weak_from_this(), wire, envelope,
+	                      callback = std::move(callback)](bool valid) {
+		auto locked = weak_this.lock();
+		if (!locked)
+			return; // the ingress has been destroyed while verifying
+
+		if (!valid) {
+			++locked->mInvalid;
+			return callback(nullptr);
+		}
+
+		callback(locked->accept(wire, envelope));
+	});
+}
+
+message_ptr Ingress::accept(shared_ptr<const binary> wire, const Message::Envelope &envelope) {
+	// Only record sequences of verified messages so forged ones can't shadow legitimate ones,
+	// this also catches duplicates which were verified concurrently
+	if (!acceptSequence(envelope)) {
+		++mDuplicate;
+		return nullptr;
+	}
+
+	++mAccepted;
+	return make_pooled<Message>(std::move(wire), envelope);
+}
+
+void Ingress::removeChannel(const Channel *channel) {
+	std::lock_guard lock(mMutex);
+	mBuckets.erase(channel);
+}
+
+Ingress::Counters Ingress::counters() const {
+	Counters result;
+	result.received = mReceived.load();
+	result.malformed = mMalformed.load();
+	result.filtered = mFiltered.load();
+	result.duplicate = mDuplicate.load();
+	result.limited = mLimited.load();
+	result.invalid = mInvalid.load();
+	result.transit = mTransit.load();
+	result.accepted = mAccepted.load();
+	return result;
+}
+
+bool Ingress::filterType(const Message::Envelope &envelope) const {
+	switch (envelope.type) {
+	case Message::Hello:
+	case Message::State:
+	case Message::Signaling:
+	case Message::Provisioning:
+	case Message::User:
+		return true;
+	default:
+		// Dummy frames carry nothing to deliver, and Fragment and Batch frames are link-local so
+		// they are unpacked before reaching the ingress
+		return false;
+	}
+}
+
+bool Ingress::checkSequence(const Message::Envelope &envelope) {
+	if (envelope.type == Message::Hello)
+		return true; // Hello messages are per link, they are not flooded
+
+	if (envelope.sealed)
+		return true; // authenticated at destination, the transport checks the sequence
+
+	SequenceKey key{Identifier(*envelope.source), envelope.type};
+	std::lock_guard lock(mMutex);
+	auto it = mSequences.find(key);
+	return it == mSequences.end() || it->second->second.check(envelope.sequence);
+}
+
+bool Ingress::acceptSequence(const Message::Envelope &envelope) {
+	if (envelope.type == Message::Hello || envelope.sealed)
+		return true;
+
+	SequenceKey key{Identifier(*envelope.source), envelope.type};
+	std::lock_guard lock(mMutex);
+	if (auto it = mSequences.find(key); it != mSequences.end()) {
+		mSequenceEntries.splice(mSequenceEntries.begin(), mSequenceEntries, it->second);
+		return it->second->second.accept(envelope.sequence);
+	}
+
+	mSequenceEntries.emplace_front(key, SequenceWindow(envelope.sequence));
+	mSequences.emplace(key, mSequenceEntries.begin());
+
+	while (mSequences.size() > MaxSequenceWindows) {
+		mSequences.erase(mSequenceEntries.back().first);
+		mSequenceEntries.pop_back();
+	}
+
+	return true;
+}
+
+bool Ingress::checkRate(const Message::Envelope &envelope, const Channel *from) {
+	if (mVerificationRate <= 0.0)
+		return true; // unlimited
+
+	// Token bucket per channel, sealed and multicast frames take tokens too as they cost a
+	// decryption or a fan-out
+	std::lock_guard lock(mMutex);
+	auto now = clock::now();
+	auto [it, inserted] = mBuckets.emplace(from, Bucket{mVerificationBurst, now});
+	auto &bucket = it->second;
+	std::chrono::duration<double> elapsed = now - bucket.time;
+	bucket.tokens =
+	    std::min(bucket.tokens + elapsed.count() * mVerificationRate, mVerificationBurst);
+	bucket.time = now;
+	if (bucket.tokens >= mVerificationBurst)
+		bucket.limited = false; // report again once the bucket has refilled
+
+	if (bucket.tokens < 1.0) {
+		if (!bucket.limited) {
+			bucket.limited = true;
+			std::cerr << "Message rate exceeded on link, dropping messages" << std::endl;
+		}
+		return false;
+	}
+
+	bucket.tokens -= 1.0;
+	return true;
+}
+
+} // namespace legio::impl
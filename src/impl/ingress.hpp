@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_INGRESS_H
+#define LEGIO_IMPL_INGRESS_H
+
+#include "common.hpp"
+#include "message.hpp"
+
+#include <rtc/channel.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace legio::impl {
+
+using rtc::Channel;
+
+// Ingress pipeline, running cheap filters before the costly signature verification:
+// header sanity, type filter, duplicate check, rate check, and verification
+// The rate check is a token bucket per channel and applies to every frame to process, signed or
+// sealed, a rate of 0 disables it
+class Ingress final : public std::enable_shared_from_this<Ingress> {
+public:
+	Ingress(unsigned verificationRate, unsigned verificationBurst);
+	~Ingress();
+
+	struct Counters {
+		uint64_t received = 0;
+		uint64_t malformed = 0;    // dropped by header sanity check
+		uint64_t filtered = 0;     // dropped by type filter
+		uint64_t duplicate = 0;    // dropped by sequence check
+		uint64_t limited = 0;      // dropped by rate check
+		uint64_t invalid = 0;      // dropped by signature verification
+		uint64_t transit = 0;      // forwarded without verification
+		uint64_t accepted = 0;
+	};
+
+	// Header sanity stage, returns nullopt if the frame must be dropped
+	optional<Message::Envelope> peek(binary_view bin);
+
+	// Filter stages before verification, returns false if the message must be dropped
+	bool filter(const Message::Envelope &envelope, const Channel *from);
+	// Filter stages for transit messages, without the sequence check as they are not verified
+	bool filterTransit(const Message::Envelope &envelope, const Channel *from);
+	// Verification stage, returns the verified message or nullptr if it must be dropped
+	message_ptr verify(shared_ptr<const binary> wire, const Message::Envelope &envelope);
+	// Non-blocking verification stage, the callback receives the message or nullptr
+	using VerifyCallback = std::function<void(message_ptr message)>;
+	void verifyAsync(shared_ptr<const binary> wire, const Message::Envelope &envelope,
+	                 VerifyCallback callback);
+
+	void removeChannel(const Channel *channel);
+
+	Counters counters() const;
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	message_ptr accept(shared_ptr<const binary> wire, const Message::Envelope &envelope);
+	bool filterType(const Message::Envelope &envelope) const;
+	bool checkSequence(const Message::Envelope &envelope);
+	bool acceptSequence(const Message::Envelope &envelope);
+	bool checkRate(const Message::Envelope &envelope, const Channel *from);
+
+	struct Bucket {
+		double tokens;
+		clock::time_point time;
+		bool limited = false; // reported as dropping, until the bucket refills
+	};
+
+	const double mVerificationRate;
+	const double mVerificationBurst;
+
+	struct SequenceKey {
+		Identifier source;
+		Message::Type type;
+
+		bool operator==(const SequenceKey &other) const {
+			return type == other.type && source == other.source;
+		}
+
+		struct hash {
+			std::size_t operator()(const SequenceKey &key) const noexcept {
+				return Identifier::hash()(key.source) ^ std::size_t(key.type);
+			}
+		};
+	};
+
+	using SequenceEntry = std::pair<SequenceKey, SequenceWindow>;
+	using sequence_iterator = std::list<SequenceEntry>::iterator;
+
+	// Bounded, the least recently accepted windows are evicted first
+	std::list<SequenceEntry> mSequenceEntries; // most recently used first
+	std::unordered_map<SequenceKey, sequence_iterator, SequenceKey::hash> mSequences;
+	std::unordered_map<const Channel *, Bucket> mBuckets;
+	std::mutex mMutex;
+
+	std::atomic<uint64_t> mReceived = 0;
+	std::atomic<uint64_t> mMalformed = 0;
+	std::atomic<uint64_t> mFiltered = 0;
+	std::atomic<uint64_t> mDuplicate = 0;
+	std::atomic<uint64_t> mLimited = 0;
+	std::atomic<uint64_t> mInvalid = 0;
+	std::atomic<uint64_t> mTransit = 0;
+	std::atomic<uint64_t> mAccepted = 0;
+};
+
+} // namespace legio::impl
+
+#endif
@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "keycache.hpp"
+
+#include <algorithm>
+
+namespace legio::impl {
+
+const size_t KeyCache::DefaultCapacity = 16384;
+const size_t KeyCache::DefaultHotCapacity = 64;
+
+// Verifications per window after which a key is promoted
+const unsigned PromotionThreshold = 32;
+const auto PromotionWindow = std::chrono::seconds(1);
+
+KeyCache &KeyCache::Instance() {
+	static KeyCache instance;
+	return instance;
+}
+
+KeyCache::KeyCache(size_t capacity, size_t hotCapacity)
+    : mCapacity(std::max(capacity, size_t(1))), mHotCapacity(hotCapacity),
+      mWindowStart(clock::now()) {}
+
+KeyCache::~KeyCache() {}
+
+shared_ptr<const PublicKey> KeyCache::get(binary_view key) {
+	binary bin = to_binary(key);
+	{
+		std::lock_guard lock(mMutex);
+		if (auto it = mIndex.find(bin); it != mIndex.end()) {
+			mEntries.splice(mEntries.begin(), mEntries, it->second);
+			return it->second->second;
+		}
+	}
+
+	// Decode and validate outside the lock
+	auto publicKey = PublicKey::Decode(key);
+	insert(std::move(bin), publicKey);
+	return publicKey;
+}
+
+void KeyCache::insert(shared_ptr<const PublicKey> publicKey) {
+	insert(publicKey->publicKey(), std::move(publicKey));
+}
+
+bool KeyCache::contains(binary_view key) const {
+	std::lock_guard lock(mMutex);
+	return mIndex.find(to_binary(key)) != mIndex.end();
+}
+
+bool KeyCache::verify(const Identifier &id, binary_view message, binary_view signature) {
+	if (auto publicKey = findHot(id))
+		return publicKey->verify(message.data(), message.size(), signature);
+
+	auto publicKey = get(id.view());
+	if (countVerification(id))
+		promote(id, *publicKey);
+
+	return publicKey->verify(message.data(), message.size(), signature);
+}
+
+void KeyCache::verifyAsync(const Identifier &id, binary_view message, binary_view signature,
+                           PublicKey::VerifyCallback callback) {
+	if (auto publicKey = findHot(id))
+		return publicKey->verifyAsync(message, signature, std::move(callback));
+
+	auto publicKey = get(id.view());
+	if (countVerification(id))
+		promote(id, *publicKey);
+
+	publicKey->verifyAsync(message, signature, std::move(callback));
+}
+
+size_t KeyCache::size() const {
+	std::lock_guard lock(mMutex);
+	return mIndex.size();
+}
+
+size_t KeyCache::capacity() const { return mCapacity; }
+
+size_t KeyCache::hotSize() const {
+	std::lock_guard lock(mHotMutex);
+	return mHotIndex.size();
+}
+
+void KeyCache::insert(binary key, shared_ptr<const PublicKey> publicKey) {
+	std::lock_guard lock(mMutex);
+	if (auto it = mIndex.find(key); it != mIndex.end()) {
+		mEntries.splice(mEntries.begin(), mEntries, it->second);
+		return;
+	}
+
+	mEntries.emplace_front(key, std::move(publicKey));
+	mIndex.emplace(std::move(key), mEntries.begin());
+
+	while (mIndex.size() > mCapacity) {
+		mIndex.erase(mEntries.back().first);
+		mEntries.pop_back();
+	}
+}
+
+shared_ptr<const PublicKey> KeyCache::findHot(const Identifier &id) {
+	std::lock_guard lock(mHotMutex);
+	auto it = mHotIndex.find(id);
+	if (it == mHotIndex.end())
+		return nullptr;
+
+	mHotEntries.splice(mHotEntries.begin(), mHotEntries, it->second);
+	return it->second->second;
+}
+
+bool KeyCache::countVerification(const Identifier &id) {
+	if (mHotCapacity == 0)
+		return false;
+
+	std::lock_guard lock(mHotMutex);
+	auto now = clock::now();
+	if (now - mWindowStart >= PromotionWindow) {
+		mVerifications.clear(); // keeps the counters bounded
+		mWindowStart = now;
+	}
+
+	return ++mVerifications[id] == PromotionThreshold;
+}
+
+void KeyCache::promote(const Identifier &id, const PublicKey &publicKey) {
+	// Precompute outside the lock
+	auto precomputed = publicKey.precomputed();
+	if (!precomputed)
+		return; // nothing to gain
+
+	std::lock_guard lock(mHotMutex);
+	if (mHotIndex.find(id) != mHotIndex.end())
+		return;
+
+	mHotEntries.emplace_front(id, std::move(precomputed));
+	mHotIndex.emplace(id, mHotEntries.begin());
+
+	while (mHotIndex.size() > mHotCapacity) {
+		mHotIndex.erase(mHotEntries.back().first);
+		mHotEntries.pop_back();
+	}
+}
+
+} // namespace legio::impl
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_KEYCACHE_H
+#define LEGIO_IMPL_KEYCACHE_H
+
+#include "common.hpp"
+#include "identifier.hpp"
+#include "keys.hpp"
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace legio::impl {
+
+// Process-wide bounded cache interning validated public keys by encoding, so that decoding and
+// validating a key already seen costs a hash lookup
+class KeyCache final {
+public:
+	static const size_t DefaultCapacity;
+	static const size_t DefaultHotCapacity;
+
+	static KeyCache &Instance();
+
+	KeyCache(size_t capacity = DefaultCapacity, size_t hotCapacity = DefaultHotCapacity);
+	~KeyCache();
+
+	// Throws if the key is invalid
+	shared_ptr<const PublicKey> get(binary_view key);
+	void insert(shared_ptr<const PublicKey> publicKey);
+	bool contains(binary_view key) const;
+
+	// Verify with the interned key, keys verifying frequently are promoted to a bounded set of
+	// keys with precomputed verification tables
+	bool verify(const Identifier &id, binary_view message, binary_view signature);
+	void verifyAsync(const Identifier &id, binary_view message, binary_view signature,
+	                 PublicKey::VerifyCallback callback);
+
+	size_t size() const;
+	size_t capacity() const;
+	size_t hotSize() const;
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	shared_ptr<const PublicKey> findHot(const Identifier &id);
+	bool countVerification(const Identifier &id);
+	void promote(const Identifier &id, const PublicKey &publicKey);
+
+	using Entry = std::pair<binary, shared_ptr<const PublicKey>>;
+	using iterator = std::list<Entry>::iterator;
+
+	void insert(binary key, shared_ptr<const PublicKey> publicKey);
+
+	const size_t mCapacity;
+	std::list<Entry> mEntries; // most recently used first
+	std::unordered_map<binary, iterator, binary_hash> mIndex;
+	mutable std::mutex mMutex;
+
+	using HotEntry = std::pair<Identifier, shared_ptr<const PublicKey>>;
+	using hot_iterator = std::list<HotEntry>::iterator;
+
+	const size_t mHotCapacity;
+	std::list<HotEntry> mHotEntries; // most recently used first
+	std::unordered_map<Identifier, hot_iterator, Identifier::hash> mHotIndex;
+	std::unordered_map<Identifier, unsigned, Identifier::hash> mVerifications; // in current window
+	clock::time_point mWindowStart;
+	mutable std::mutex mHotMutex;
+};
+
+} // namespace legio::impl
+
+#endif
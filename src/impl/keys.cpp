@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "keys.hpp"
+#include "ecdsa.hpp"
+#include "ed25519.hpp"
+#include "opensslecdsa.hpp"
+#include "webcrypto.hpp"
+
+namespace legio::impl {
+
+shared_ptr<const PublicKey> PublicKey::Decode(binary_view key) {
+	if (key.empty())
+		throw std::invalid_argument("Empty public key");
+
+	if (key[0] == Ed25519Public::Prefix)
+		return std::make_shared<const Ed25519Public>(key);
+
+#if LEGIO_USE_OPENSSL
+	return std::make_shared<const OpenSslEcdsaPublic>(key);
+#elif defined(__EMSCRIPTEN__)
+	return std::make_shared<const WebCryptoEcdsaPublic>(key);
+#else
+	return std::make_shared<const EcdsaPublic>(key);
+#endif
+}
+
+PublicKey::~PublicKey() {}
+
+bool PublicKey::verify(const binary &message, const binary &signature) const {
+	return verify(message.data(), message.size(), signature);
+}
+
+void PublicKey::verifyAsync(binary_view message, binary_view signature,
+                            VerifyCallback callback) const {
+	callback(verify(message.data(), message.size(), signature));
+}
+
+shared_ptr<const PublicKey> PublicKey::precomputed() const { return nullptr; }
+
+unique_ptr<KeyPair> KeyPair::Generate(KeyType type) {
+	switch (type) {
+	case KeyType::P256:
+#if LEGIO_USE_OPENSSL
+		return std::make_unique<OpenSslEcdsaPair>();
+#else
+		return std::make_unique<EcdsaPair>();
+#endif
+	case KeyType::Curve25519:
+		return std::make_unique<Ed25519Pair>();
+	default:
+		throw std::invalid_argument("Unknown key type");
+	}
+}
+
+KeyPair::~KeyPair() {}
+
+binary KeyPair::sign(const binary &message) const { return sign(message.data(), message.size()); }
+
+} // namespace legio::impl
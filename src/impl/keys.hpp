@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_KEYS_H
+#define LEGIO_IMPL_KEYS_H
+
+#include "common.hpp"
+#include "configuration.hpp" // for KeyType
+
+namespace legio::impl {
+
+// Public signing key, whatever its type
+class PublicKey {
+public:
+	// Decode an encoded key as found in identifiers, throws if it is invalid
+	static shared_ptr<const PublicKey> Decode(binary_view key);
+
+	virtual ~PublicKey();
+
+	virtual KeyType type() const = 0;
+
+	// Encoding of Identifier::Size bytes, the first one telling the key type
+	virtual binary publicKey() const = 0;
+
+	virtual bool verify(const byte *message, size_t size, binary_view signature) const = 0;
+	bool verify(const binary &message, const binary &signature) const;
+
+	// Verify without blocking, the callback is called once and possibly before returning
+	// The views only need to be valid during the call, the default implementation is synchronous
+	using VerifyCallback = std::function<void(bool valid)>;
+	virtual void verifyAsync(binary_view message, binary_view signature,
+	                         VerifyCallback callback) const;
+
+	// Copy with precomputed verification tables, or null if verification would not benefit
+	virtual shared_ptr<const PublicKey> precomputed() const;
+};
+
+// Signing key pair, whatever its type
+class KeyPair {
+public:
+	static unique_ptr<KeyPair> Generate(KeyType type);
+
+	virtual ~KeyPair();
+
+	virtual KeyType type() const = 0;
+	virtual shared_ptr<const PublicKey> publicPart() const = 0;
+
+	virtual binary sign(const byte *message, size_t size) const = 0;
+	binary sign(const binary &message) const;
+};
+
+} // namespace legio::impl
+
+#endif
@@ -18,71 +18,207 @@
 
 #include "message.hpp"
 #include "aesgcm.hpp"
+#include "keycache.hpp"
+#include "session.hpp"
 #include "sha.hpp"
 
+#include <atomic>
 #include <iostream>
 #include <limits>
 
 namespace legio::impl {
 
+const size_t Message::MaxBodySize = 16 * 1024 * 1024;
+
 Message Message::Create(Type _type, uint32_t _sequence, binary _body,
-                        optional<EcdsaPair> sourceEcdsaPair, optional<Identifier> destination) {
+                        optional<key_pair_ref> sourceKeyPair, optional<Identifier> destination) {
+	Message message(_type, std::move(_body), std::move(destination));
+	message.sequence = _sequence;
+	if (sourceKeyPair)
+		message.sign(sourceKeyPair->get());
+
+	return message;
+}
+
+Message Message::CreateSealed(Type _type, uint32_t _sequence, binary _body, Identifier source,
+                              Identifier destination) {
 	Message message(_type, std::move(_body), std::move(destination));
 	message.sequence = _sequence;
-	if (sourceEcdsaPair)
-		message.sign(*sourceEcdsaPair);
+	message.source = std::move(source);
+	message.sealed = true;
+	return message;
+}
 
+Message Message::CreateMulticast(Type _type, uint32_t _sequence, binary _body,
+                                 Identifier source) {
+	Message message(_type, std::move(_body));
+	message.sequence = _sequence;
+	message.source = std::move(source);
+	message.sealed = true;
+	message.multicast = true;
 	return message;
 }
 
+binary Message::AssociatedData(Type _type, uint32_t _sequence, const Identifier &source,
+                               const Identifier &destination) {
+	binary_writer writer;
+	writer.data().reserve(1 + 4 + 2 * Identifier::Size);
+	writer.writeInt(static_cast<uint8_t>(_type));
+	writer.writeInt(_sequence);
+	writer.write(source.view());
+	writer.write(destination.view());
+	return writer.data();
+}
+
 Message::Message(Type _type, binary _body, optional<Identifier> _destination)
     : type(_type), body(std::move(_body)), destination(std::move(_destination)) {}
 
-Message::Message(const binary &bin) {
-	// OPTI: prevent copy
+Message::Envelope Message::Peek(binary_view bin) {
 	binary_reader reader(bin);
 
 	Header header;
 	static_assert(sizeof(header) == 8, "Message header length must be 8 bytes");
 	reader.read(reinterpret_cast<byte *>(&header), sizeof(header));
 
-	type = static_cast<Message::Type>(header.type);
-	sequence = ntohl(header.sequence);
+	Envelope envelope;
+	envelope.type = static_cast<Message::Type>(header.type);
+	envelope.sequence = ntohl(header.sequence);
 	size_t length = ntohs(header.length);
 
+	if (header.flags & LongBody) {
+		uint32_t longLength = 0;
+		reader.readInt(longLength);
+		if (length != 0 || longLength <= std::numeric_limits<uint16_t>::max() ||
+		    longLength > MaxBodySize)
+			throw std::invalid_argument("Invalid message body length");
+
+		length = longLength;
+	}
+
 	if (header.flags & HasSource)
-		source = reader.read(Identifier::Size);
+		envelope.source = reader.readView(Identifier::Size);
 
 	if (header.flags & HasDestination)
-		destination = reader.read(Identifier::Size);
+		envelope.destination = reader.readView(Identifier::Size);
+
+	envelope.body = reader.readView(length);
+
+	// The signature covers everything before it
+	envelope.signedPart = bin.subview(0, reader.position());
+	envelope.signature = reader.leftView();
+
+	if (header.flags & Sealed) {
+		// Sealed messages have exactly one destination, or multiple ones in the body
+		bool multicast = header.flags & Multicast;
+		if (!envelope.source || bool(envelope.destination) == multicast ||
+		    !envelope.signature.empty())
+			throw std::invalid_argument("Invalid sealed message");
+
+		envelope.sealed = true;
+		envelope.multicast = multicast;
 
-	body = reader.read(length);
-	signature = reader.left();
+	} else if (header.flags & Multicast) {
+		throw std::invalid_argument("Unsealed multicast message");
+	}
 
-	if (source &&
-	    !EcdsaPublic(*source).verify(bin.data(), bin.size() - signature.size(), signature))
+	return envelope;
+}
+
+const Message::Envelope &Message::Verified(const Envelope &envelope) {
+	if (!envelope.verify())
 		throw std::invalid_argument("Message signature is invalid");
+
+	return envelope;
+}
+
+bool Message::Envelope::verify() const {
+	if (!source || sealed)
+		return true; // unsigned, or authenticated at destination
+
+	return KeyCache::Instance().verify(Identifier(*source), signedPart, signature);
+}
+
+void Message::Envelope::verifyAsync(PublicKey::VerifyCallback callback) const {
+	if (!source || sealed)
+		return callback(true); // unsigned, or authenticated at destination
+
+	KeyCache::Instance().verifyAsync(Identifier(*source), signedPart, signature,
+	                                 std::move(callback));
+}
+
+Message::Message(const Envelope &envelope)
+    : type(envelope.type), sequence(envelope.sequence),
+      body(BufferPool::Instance().copy(envelope.body)),
+      signature(BufferPool::Instance().copy(envelope.signature)), sealed(envelope.sealed),
+      multicast(envelope.multicast) {
+	if (envelope.source)
+		source.emplace(*envelope.source);
+
+	if (envelope.destination)
+		destination.emplace(*envelope.destination);
+}
+
+Message::Message(binary_view bin) : Message(Verified(Peek(bin))) {}
+
+Message::Message(shared_ptr<const binary> _wire) : Message(binary_view(*_wire)) {
+	std::atomic_store(&mWire, std::move(_wire));
 }
 
-void Message::sign(const EcdsaPair &sourceEcdsaPair) {
-	source = Identifier(sourceEcdsaPair);
+Message::Message(shared_ptr<const binary> _wire, const Envelope &verified) : Message(verified) {
+	std::atomic_store(&mWire, std::move(_wire));
+}
+
+Message::~Message() {
+	auto &pool = BufferPool::Instance();
+	pool.recycle(std::move(body));
+	pool.recycle(std::move(signature));
+}
+
+void Message::sign(const KeyPair &sourceKeyPair) {
+	source = Identifier(sourceKeyPair);
+	sealed = false;
+	multicast = false;
 
 	// Clear the signature and sign the binary representation without signature
 	signature.clear();
-	signature = sourceEcdsaPair.sign(binary(*this));
+	binary data(*this);
+	signature = sourceKeyPair.sign(data.data(), data.size());
+
+	// The signed representation followed by the signature is the new wire representation
+	data.insert(data.end(), signature.begin(), signature.end());
+	std::atomic_store(&mWire, BufferPool::Instance().share(std::move(data)));
 }
 
+shared_ptr<const binary> Message::wire() const {
+	if (auto wire = cachedWire())
+		return wire;
+
+	// Concurrent callers might serialize twice, but the result is identical
+	auto wire = BufferPool::Instance().share(binary(*this));
+	std::atomic_store(&mWire, wire);
+	return wire;
+}
+
+shared_ptr<const binary> Message::cachedWire() const { return std::atomic_load(&mWire); }
+
+void Message::invalidate() { std::atomic_store(&mWire, shared_ptr<const binary>()); }
+
 Message::operator binary() const {
-	if (body.size() > std::numeric_limits<uint16_t>::max())
+	if (body.size() > MaxBodySize)
 		throw std::runtime_error("Message body is too long");
 
-	binary_writer writer;
+	// Gather the header with references to the body and signature, so they are copied once
+	auto &pool = BufferPool::Instance();
+	binary_writer writer(pool.take(sizeof(Header) + 4 + 2 * Identifier::Size));
+
+	// Bodies which don't fit the 16-bit length are preceded by a 32-bit length instead
+	bool longBody = body.size() > std::numeric_limits<uint16_t>::max();
 
 	Header header;
 	static_assert(sizeof(header) == 8, "header length must be 8 bytes");
 	header.type = static_cast<uint8_t>(type);
 	header.flags = 0;
-	header.length = htons(body.size());
+	header.length = longBody ? 0 : htons(uint16_t(body.size()));
 	header.sequence = htonl(sequence);
 
 	if (source)
@@ -91,58 +227,197 @@ Message::operator binary() const {
 	if (destination)
 		header.flags |= HasDestination;
 
+	if (sealed)
+		header.flags |= Sealed;
+
+	if (multicast)
+		header.flags |= Multicast;
+
+	if (longBody)
+		header.flags |= LongBody;
+
 	writer.write(reinterpret_cast<const byte *>(&header), sizeof(header));
 
+	if (longBody)
+		writer.writeInt(uint32_t(body.size()));
+
 	if (source)
-		writer.write(*source);
+		writer.write(source->view());
 
 	if (destination)
-		writer.write(*destination);
+		writer.write(destination->view());
 
-	writer.write(body);
-	writer.write(signature);
+	writer.writeRef(body);
+	writer.writeRef(signature);
 
-	return writer.data();
+	binary frame = writer.flatten(pool.take(writer.size()));
+	pool.recycle(std::move(writer.data()));
+	return frame;
 }
 
 CipherBody CipherBody::Encrypt(const binary &cleartext, const Ecdh &ecdh, binary _destination) {
-	binary sharedKey = Sha256(ecdh.agree(_destination));
-	AesGcmEncryption encryption(std::move(sharedKey));
+	binary key = Session::DeriveKey(ecdh.agree(_destination), CipherSuite::AesGcm,
+	                                ecdh.publicKey(), _destination);
+	AesGcmEncryption encryption(std::move(key));
 	CipherBody body;
 	body.source = ecdh.publicKey();
 	body.destination = std::move(_destination);
+	body.suite = encryption.suite();
 	body.iv = encryption.iv();
 	body.ciphertext = encryption.encrypt(cleartext);
 	return body;
 }
 
+CipherBody CipherBody::Encrypt(const binary &cleartext, Session &session, binary_view ad) {
+	auto [iv, ciphertext] = session.encrypt(cleartext, ad);
+	CipherBody body;
+	body.source = session.localPublicKey();
+	body.destination = session.remotePublicKey();
+	body.suite = session.suite();
+	body.iv = std::move(iv);
+	body.ciphertext = std::move(ciphertext);
+	return body;
+}
+
+binary CipherBody::Seal(binary_view cleartext, Session &session, binary_view ad) {
+	const binary &source = session.localPublicKey();
+	const binary &destination = session.remotePublicKey();
+	auto suite = session.suite();
+	size_t ivSize = CipherSuiteNonceSize(suite);
+	size_t offset = source.size() + destination.size() + 1 + ivSize;
+	size_t size = offset + cleartext.size() + AeadEncryption::TagSize;
+
+	binary body = BufferPool::Instance().take(size);
+	body.insert(body.end(), source.begin(), source.end());
+	body.insert(body.end(), destination.begin(), destination.end());
+	body.push_back(byte(suite));
+	body.resize(size);
+
+	// The IV is only known once encrypted, it is written in the space left before the ciphertext
+	binary iv = session.encrypt(cleartext, body.data() + offset, ad);
+	if (iv.size() != ivSize)
+		throw std::logic_error("Unexpected IV size");
+
+	std::copy(iv.begin(), iv.end(), body.begin() + (offset - ivSize));
+	return body;
+}
+
 CipherBody::CipherBody() {}
 
-CipherBody::CipherBody(const binary &body) {
-	// OPTI: prevent copy
+CipherBody::CipherBody(binary_view body) {
 	binary_reader reader(body);
-	source = reader.read(Ecdh::KeySize);
-	destination = reader.read(Ecdh::KeySize);
-	iv = reader.read(16);
-	ciphertext = reader.left();
+	source = reader.read(Ecdh::KeySize(reader.leftView()));
+	destination = reader.read(Ecdh::KeySize(reader.leftView()));
+	uint8_t s = 0;
+	reader.read(reinterpret_cast<byte *>(&s), 1);
+	suite = static_cast<CipherSuite>(s);
+	iv = reader.read(CipherSuiteNonceSize(suite));
+	ciphertext = BufferPool::Instance().copy(reader.leftView());
 }
 
 binary CipherBody::decrypt(const Ecdh &ecdh) {
 	if (ecdh.publicKey() != destination)
 		throw std::runtime_error("Destination ECDH public key does not match");
 
-	binary sharedKey = Sha256(ecdh.agree(source));
-	AesGcmDecryption decryption(std::move(sharedKey), iv);
+	if (suite != CipherSuite::AesGcm)
+		throw std::runtime_error("Unexpected cipher suite");
+
+	binary key =
+	    Session::DeriveKey(ecdh.agree(source), CipherSuite::AesGcm, source, ecdh.publicKey());
+	AesGcmDecryption decryption(std::move(key), iv);
 	return decryption.decrypt(ciphertext);
 }
 
+binary CipherBody::decrypt(Session &session, binary_view ad) {
+	if (session.localPublicKey() != destination || session.remotePublicKey() != source)
+		throw std::runtime_error("Session ECDH public keys do not match");
+
+	if (session.suite() != suite)
+		throw std::runtime_error("Session cipher suite does not match");
+
+	// Decrypt in place, the ciphertext buffer becomes the cleartext
+	session.decrypt(iv, ciphertext, ad);
+	return std::move(ciphertext);
+}
+
 CipherBody::operator binary() const {
-	binary_writer writer;
+	binary_writer writer(BufferPool::Instance().take(source.size() + destination.size() + 1 +
+	                                                 iv.size() + ciphertext.size()));
 	writer.write(source);
 	writer.write(destination);
+	uint8_t s = static_cast<uint8_t>(suite);
+	writer.write(reinterpret_cast<const byte *>(&s), 1);
 	writer.write(iv);
 	writer.write(ciphertext);
-	return writer.data();
+	return std::move(writer.data());
+}
+
+const size_t MulticastBody::ContentKeySize = 32;
+
+MulticastBody::MulticastBody(CipherSuite _suite, binary _iv, binary _ciphertext)
+    : suite(_suite), iv(std::move(_iv)), ciphertext(std::move(_ciphertext)) {}
+
+MulticastBody::MulticastBody(binary_view body) {
+	binary_reader reader(body);
+	uint16_t count = 0;
+	reader.readInt(count);
+	recipients.reserve(count);
+	for (uint16_t i = 0; i < count; ++i) {
+		Identifier id(reader.readView(Identifier::Size));
+		binary source = reader.read(Ecdh::KeySize(reader.leftView()));
+		uint8_t s = 0;
+		reader.readInt(s);
+		auto recipientSuite = static_cast<CipherSuite>(s);
+		binary recipientIv = reader.read(CipherSuiteNonceSize(recipientSuite));
+		binary wrappedKey = reader.read(ContentKeySize + AeadDecryption::TagSize);
+		recipients.push_back({id, std::move(source), recipientSuite, std::move(recipientIv),
+		                      std::move(wrappedKey)});
+	}
+
+	uint8_t s = 0;
+	reader.readInt(s);
+	suite = static_cast<CipherSuite>(s);
+	iv = reader.read(CipherSuiteNonceSize(suite));
+	ciphertext = BufferPool::Instance().copy(reader.leftView());
+}
+
+binary MulticastBody::digest() const {
+	binary content;
+	content.reserve(1 + iv.size() + ciphertext.size());
+	content.push_back(byte(suite));
+	content.insert(content.end(), iv.begin(), iv.end());
+	content.insert(content.end(), ciphertext.begin(), ciphertext.end());
+	return Sha256(content);
+}
+
+binary MulticastBody::decrypt(const binary &contentKey) const {
+	auto decryption = AeadDecryption::Create(suite, contentKey);
+	decryption->resynchronize(iv);
+	return decryption->decrypt(ciphertext);
+}
+
+MulticastBody::operator binary() const {
+	if (recipients.size() > std::numeric_limits<uint16_t>::max())
+		throw std::runtime_error("Too many multicast recipients");
+
+	size_t size = 2 + 1 + iv.size() + ciphertext.size();
+	for (const auto &recipient : recipients)
+		size += Identifier::Size + recipient.source.size() + 1 + recipient.iv.size() +
+		        recipient.wrappedKey.size();
+
+	binary_writer writer(BufferPool::Instance().take(size));
+	writer.writeInt(uint16_t(recipients.size()));
+	for (const auto &recipient : recipients) {
+		writer.write(recipient.id.view());
+		writer.write(recipient.source);
+		writer.writeInt(static_cast<uint8_t>(recipient.suite));
+		writer.write(recipient.iv);
+		writer.write(recipient.wrappedKey);
+	}
+	writer.writeInt(static_cast<uint8_t>(suite));
+	writer.write(iv);
+	writer.write(ciphertext);
+	return std::move(writer.data());
 }
 
 } // namespace legio::impl
@@ -20,12 +20,16 @@
 #define LEGIO_IMPL_MESSAGE_H
 
 #include "common.hpp"
+#include "bufferpool.hpp"
+#include "cipher.hpp"
 #include "ecdh.hpp"
-#include "ecdsa.hpp"
 #include "identifier.hpp"
+#include "keys.hpp"
 
 namespace legio::impl {
 
+using key_pair_ref = std::reference_wrapper<const KeyPair>;
+
 #pragma pack(push, 1)
 struct Header {
 	uint8_t type;
@@ -43,6 +47,8 @@ public:
 		// Routing
 		Hello = 0x01,
 		State = 0x02,
+		Fragment = 0x03, // link-local, see Fragmentation
+		Batch = 0x04,    // link-local, see Coalescing
 
 		// Signaling
 		Signaling = 0x10,
@@ -52,15 +58,65 @@ public:
 		User = 0x80
 	};
 
-	enum Flags : uint8_t { None = 0x00, HasSource = 0x01, HasDestination = 0x02 };
+	enum Flags : uint8_t {
+		None = 0x00,
+		HasSource = 0x01,
+		HasDestination = 0x02,
+		Sealed = 0x04,
+		Multicast = 0x08, // sealed, the body is a MulticastBody instead of a destination
+		LongBody = 0x10   // the header length is zero and a 32-bit length follows the header
+	};
+
+	static const size_t MaxBodySize;
 
 	static Message Create(Type _type, uint32_t sequence, binary _body = binary(),
-	                      optional<EcdsaPair> sourceEcdsaPair = nullopt,
+	                      optional<key_pair_ref> sourceKeyPair = nullopt,
 	                      optional<Identifier> destination = nullopt);
 
-	Message(const binary &bin);
+	// Sealed messages are not signed, the encrypted body authenticates them instead with the
+	// header fields as associated data, so they must have a source and a destination
+	static Message CreateSealed(Type _type, uint32_t sequence, binary _body, Identifier source,
+	                            Identifier destination);
+	static Message CreateMulticast(Type _type, uint32_t sequence, binary _body, Identifier source);
+	static binary AssociatedData(Type _type, uint32_t sequence, const Identifier &source,
+	                             const Identifier &destination);
+
+	// Fields of a frame, peeked in place without verifying the signature
+	struct Envelope {
+		Type type;
+		uint32_t sequence;
+		optional<binary_view> source;
+		optional<binary_view> destination;
+		binary_view body;
+		binary_view signature;
+		binary_view signedPart; // everything before the signature
+		bool sealed = false;    // no signature, authenticated at destination
+		bool multicast = false; // sealed for multiple destinations
+
+		bool verify() const;
+		void verifyAsync(PublicKey::VerifyCallback callback) const;
+	};
+
+	static Envelope Peek(binary_view bin);
+
+	Message(binary_view bin);
+	Message(shared_ptr<const binary> wire); // keeps the received frame as wire representation
+	Message(shared_ptr<const binary> wire, const Envelope &verified); // skips verification
+	Message(const Message &other) = default;
+	Message(Message &&other) = default;
+	~Message(); // gives the body back to the buffer pool
+
+	Message &operator=(const Message &other) = default;
+	Message &operator=(Message &&other) = default;
+
+	void sign(const KeyPair &sourceKeyPair);
 
-	void sign(const EcdsaPair &sourceEcdsaPair);
+	// Wire representation, serialized once and shared by every send and forward
+	shared_ptr<const binary> wire() const;
+	// Wire representation if already serialized, nullptr otherwise
+	shared_ptr<const binary> cachedWire() const;
+	// Drop the cached wire representation, must be called after any field is modified
+	void invalidate();
 
 	operator binary() const;
 
@@ -70,36 +126,91 @@ public:
 	optional<Identifier> destination;
 	binary body;
 	binary signature;
+	bool sealed = false;
+	bool multicast = false;
 
 private:
 	Message(Type type, binary body, optional<Identifier> destination = nullopt);
+	Message(const Envelope &envelope);
+
+	static const Envelope &Verified(const Envelope &envelope);
+
+	mutable shared_ptr<const binary> mWire; // accessed atomically
 };
 
+class Session;
+
 struct CipherBody {
 	static CipherBody Encrypt(const binary &cleartext, const Ecdh &ecdh, binary _destination);
+	static CipherBody Encrypt(const binary &cleartext, Session &session, binary_view ad = {});
+	// Encrypt directly into the serialized body, without an intermediate ciphertext
+	static binary Seal(binary_view cleartext, Session &session, binary_view ad = {});
 
-	CipherBody(const binary &body);
+	CipherBody(binary_view body);
 
 	binary decrypt(const Ecdh &ecdh);
+	binary decrypt(Session &session, binary_view ad = {}); // consumes the ciphertext
 
 	operator binary() const;
 
 	binary source;
 	binary destination;
-	binary iv;
+	CipherSuite suite;
+	binary iv; // size depends on the suite
 	binary ciphertext;
 
 private:
 	CipherBody();
 };
 
+// Body of a multicast message, the payload is encrypted once with a random content key which is
+// wrapped for each recipient with its session, entries are dropped from copies as routes diverge
+struct MulticastBody {
+	static const size_t ContentKeySize;
+
+	struct Recipient {
+		Identifier id;
+		binary source; // ECDH public key the sender wrapped the content key with
+		CipherSuite suite;
+		binary iv;
+		binary wrappedKey; // content key followed by the tag
+	};
+
+	MulticastBody(CipherSuite _suite, binary _iv, binary _ciphertext);
+	MulticastBody(binary_view body);
+
+	// Digest of the content, bound to the wrapping of each key so recipients can't forge it
+	binary digest() const;
+
+	binary decrypt(const binary &contentKey) const;
+
+	operator binary() const;
+
+	std::vector<Recipient> recipients;
+	CipherSuite suite;
+	binary iv;
+	binary ciphertext;
+};
+
 using message_ptr = shared_ptr<Message>;
 
 inline message_ptr make_message(Message::Type _type, uint32_t sequence, binary _body = binary(),
-                                optional<EcdsaPair> sourceEcdsaPair = nullopt,
+                                optional<key_pair_ref> sourceKeyPair = nullopt,
                                 optional<Identifier> destination = nullopt) {
-	return std::make_shared<Message>(Message::Create(
-	    _type, sequence, std::move(_body), std::move(sourceEcdsaPair), std::move(destination)));
+	return make_pooled<Message>(Message::Create(
+	    _type, sequence, std::move(_body), std::move(sourceKeyPair), std::move(destination)));
+}
+
+inline message_ptr make_multicast_message(Message::Type _type, uint32_t sequence, binary _body,
+                                          Identifier source) {
+	return make_pooled<Message>(
+	    Message::CreateMulticast(_type, sequence, std::move(_body), source));
+}
+
+inline message_ptr make_sealed_message(Message::Type _type, uint32_t sequence, binary _body,
+                                       Identifier source, Identifier destination) {
+	return make_pooled<Message>(
+	    Message::CreateSealed(_type, sequence, std::move(_body), source, destination));
 }
 
 inline int compare_sequence(uint32_t s1, uint32_t s2) {
@@ -111,6 +222,41 @@ inline int compare_sequence(uint32_t s1, uint32_t s2) {
 		return -1; // s1 < s2
 }
 
+// Anti-replay window, accepting recent unseen sequences even if they arrive out of order
+class SequenceWindow {
+public:
+	static const uint32_t Size = 64;
+
+	SequenceWindow(uint32_t first) : mLast(first), mMask(1) {}
+
+	bool check(uint32_t sequence) const {
+		if (compare_sequence(sequence, mLast) > 0)
+			return true;
+
+		uint32_t offset = mLast - sequence;
+		return offset < Size && !(mMask & (uint64_t(1) << offset));
+	}
+
+	// Returns false if the sequence is rejected
+	bool accept(uint32_t sequence) {
+		if (!check(sequence))
+			return false;
+
+		if (compare_sequence(sequence, mLast) > 0) {
+			uint32_t shift = sequence - mLast;
+			mMask = shift < Size ? (mMask << shift) | 1 : 1;
+			mLast = sequence;
+		} else {
+			mMask |= uint64_t(1) << (mLast - sequence);
+		}
+		return true;
+	}
+
+private:
+	uint32_t mLast;
+	uint64_t mMask; // bit i is set if sequence mLast - i has been seen
+};
+
 } // namespace legio::impl
 
 #endif
@@ -24,6 +24,7 @@
 #include "rtc/rtc.hpp" // for rtc::InitLogger
 
 #include <algorithm>
+#include <thread>
 
 namespace {
 
@@ -41,22 +42,56 @@ namespace legio::impl {
 
 using namespace std::placeholders;
 
+const size_t CryptoQueueSize = 1024;
+
+namespace {
+
+unsigned DefaultCryptoThreads() {
+#ifdef __EMSCRIPTEN__
+	return 0; // send synchronously
+#else
+	return std::max(std::thread::hardware_concurrency(), 1u);
+#endif
+}
+
+template <typename F> std::future<void> run_async(ThreadPool &pool, size_t key, F func) {
+	auto promise = std::make_shared<std::promise<void>>();
+	auto future = promise->get_future();
+	pool.enqueue(key, [func = std::move(func), promise]() {
+		try {
+			func();
+			promise->set_value();
+		} catch (...) {
+			promise->set_exception(std::current_exception());
+		}
+	});
+	return future;
+}
+
+} // namespace
+
 Node::Node(Configuration _config)
-    : config(std::move(_config)), scheduler(std::make_unique<Scheduler>()),
+    : config(std::move(_config)), keyPair(KeyPair::Generate(config.keyType.value_or(KeyType::P256))),
+      identifier(*keyPair), scheduler(std::make_unique<Scheduler>()),
       routing(std::make_shared<Routing>(this)), graph(std::make_shared<Graph>(this)),
 #ifndef __EMSCRIPTEN__
       server(config.port ? std::make_shared<Server>(config, this) : nullptr),
 #endif
       networking(std::make_shared<Networking>(this)),
       userTransport(std::make_unique<BroadcastableTransport>(
-          this, Message::User, std::bind(&Node::receive, this, _1, _2))) {
+          this, Message::User, std::bind(&Node::receive, this, _1, _2))),
+      cryptoPool(std::make_unique<ThreadPool>(config.cryptoThreads.value_or(DefaultCryptoThreads()),
+                                              CryptoQueueSize)) {
 
 #ifndef __EMSCRIPTEN__
 	rtc::InitLogger(rtc::LogLevel::Warning);
 #endif
 }
 
-Node::~Node() {}
+Node::~Node() {
+	// Verification tasks call into every component, join them before any is destroyed
+	routing->shutdown();
+}
 
 void Node::attach(Component *component) { mComponents.push_back(component); }
 
@@ -96,6 +131,34 @@ void Node::connect(string url) {
 	}
 }
 
+std::vector<Identifier> Node::sendMany(std::vector<Identifier> remoteIds, binary payload) {
+	// Remove duplicates and the local node so that each recipient gets a single key
+	std::sort(remoteIds.begin(), remoteIds.end());
+	remoteIds.erase(std::unique(remoteIds.begin(), remoteIds.end()), remoteIds.end());
+	remoteIds.erase(std::remove(remoteIds.begin(), remoteIds.end(), identifier), remoteIds.end());
+	if (remoteIds.empty())
+		return {};
+
+	return userTransport->sendMany(std::move(remoteIds), std::move(payload));
+}
+
+std::future<void> Node::sendAsync(Identifier remoteId, binary payload) {
+	// Keying by destination keeps messages to the same destination in order
+	size_t key = Identifier::hash()(remoteId);
+	return run_async(*cryptoPool, key,
+	                 [this, remoteId = std::move(remoteId), payload = std::move(payload)]() {
+		                 userTransport->send(remoteId, payload);
+	                 });
+}
+
+std::future<void> Node::broadcastAsync(binary payload) {
+	// Broadcasts are ordered between themselves
+	size_t key = 0;
+	return run_async(*cryptoPool, key, [this, payload = std::move(payload)]() {
+		userTransport->broadcast(payload);
+	});
+}
+
 void Node::receive(Identifier id, binary payload) {
 	std::lock_guard lock(messageCallbackMutex);
 	if (messageCallback)
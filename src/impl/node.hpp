@@ -22,18 +22,20 @@
 #include "common.hpp"
 #include "component.hpp"
 #include "configuration.hpp"
-#include "ecdsa.hpp"
 #include "graph.hpp"
 #include "identifier.hpp"
+#include "keys.hpp"
 #include "networking.hpp"
 #include "routing.hpp"
 #include "scheduler.hpp"
+#include "threadpool.hpp"
 #include "transport.hpp"
 
 #ifndef __EMSCRIPTEN__
 #include "server.hpp"
 #endif
 
+#include <future>
 #include <mutex>
 
 namespace legio::impl {
@@ -46,8 +48,8 @@ public:
 	Node(Configuration _config);
 	~Node();
 
-	inline Identifier id() const { return Identifier(ecdsaPair); }
-	inline const EcdsaPublic &publicKey() const { return ecdsaPair; }
+	inline Identifier id() const { return identifier; }
+	inline const PublicKey &publicKey() const { return *keyPair->publicPart(); }
 
 	void attach(Component *component);
 	void detach(Component *component);
@@ -60,8 +62,14 @@ public:
 
 	void receive(Identifier id, binary payload);
 
+	std::vector<Identifier> sendMany(std::vector<Identifier> remoteIds, binary payload);
+
+	std::future<void> sendAsync(Identifier remoteId, binary payload);
+	std::future<void> broadcastAsync(binary payload);
+
 	const Configuration config;
-	const EcdsaPair ecdsaPair;
+	const unique_ptr<const KeyPair> keyPair;
+	const Identifier identifier;
 	const unique_ptr<Scheduler> scheduler;
 	const shared_ptr<Routing> routing;
 	const shared_ptr<Graph> graph;
@@ -74,6 +82,9 @@ public:
 	using MessageCallback = std::function<void(Identifier remoteId, binary payload)>;
 	MessageCallback messageCallback;
 	std::mutex messageCallbackMutex;
+
+	// Last so that pending sends are joined first on destruction
+	const unique_ptr<ThreadPool> cryptoPool;
 };
 
 } // namespace legio::impl
@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#if LEGIO_USE_OPENSSL
+
+#include "openssl.hpp"
+
+#include <openssl/ec.h>
+#include <openssl/rand.h>
+#include <openssl/x509.h>
+
+#include <cassert>
+#include <vector>
+
+namespace legio::impl {
+
+namespace {
+
+const size_t P256_COORD_SIZE = 32;
+
+// DER SubjectPublicKeyInfo headers for P-256, the point follows as the bit string content
+const unsigned char P256_COMPRESSED_SPKI[] = {0x30, 0x39, 0x30, 0x13, 0x06, 0x07, 0x2a,
+                                              0x86, 0x48, 0xce, 0x3d, 0x02, 0x01, 0x06,
+                                              0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03,
+                                              0x01, 0x07, 0x03, 0x22, 0x00};
+const unsigned char P256_UNCOMPRESSED_SPKI[] = {0x30, 0x59, 0x30, 0x13, 0x06, 0x07, 0x2a,
+                                                0x86, 0x48, 0xce, 0x3d, 0x02, 0x01, 0x06,
+                                                0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03,
+                                                0x01, 0x07, 0x03, 0x42, 0x00};
+
+} // namespace
+
+EVP_PKEY *OpenSslGenerateP256() {
+	EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+	if (!ctx)
+		throw std::runtime_error("Failed to create OpenSSL key context");
+
+	EVP_PKEY *pkey = nullptr;
+	bool success = EVP_PKEY_keygen_init(ctx) > 0 &&
+	               EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx, NID_X9_62_prime256v1) > 0 &&
+	               EVP_PKEY_keygen(ctx, &pkey) > 0;
+
+	EVP_PKEY_CTX_free(ctx);
+	if (!success)
+		throw std::runtime_error("Failed to generate P-256 key");
+
+	return pkey;
+}
+
+EVP_PKEY *OpenSslDecodeP256(binary_view point) {
+	// Wrapping the point in a SubjectPublicKeyInfo avoids the EC_KEY API deprecated in OpenSSL 3
+	const unsigned char *prefix;
+	size_t prefixSize;
+	if (point.size() == 1 + P256_COORD_SIZE) {
+		prefix = P256_COMPRESSED_SPKI;
+		prefixSize = sizeof(P256_COMPRESSED_SPKI);
+	} else if (point.size() == 1 + 2 * P256_COORD_SIZE) {
+		prefix = P256_UNCOMPRESSED_SPKI;
+		prefixSize = sizeof(P256_UNCOMPRESSED_SPKI);
+	} else {
+		throw std::invalid_argument("Invalid P-256 point size");
+	}
+
+	std::vector<unsigned char> der(prefix, prefix + prefixSize);
+	auto p = reinterpret_cast<const unsigned char *>(point.data());
+	der.insert(der.end(), p, p + point.size());
+
+	// Decoding checks the point is on the curve, which has a cofactor of 1
+	const unsigned char *in = der.data();
+	EVP_PKEY *pkey = d2i_PUBKEY(nullptr, &in, long(der.size()));
+	if (!pkey)
+		throw std::runtime_error("Failed to validate external P-256 public key");
+
+	return pkey;
+}
+
+binary OpenSslEncodeP256(EVP_PKEY *pkey, bool compressed) {
+	// The encoded SubjectPublicKeyInfo ends with the uncompressed point
+	int len = i2d_PUBKEY(pkey, nullptr);
+	if (len < int(1 + 2 * P256_COORD_SIZE))
+		throw std::runtime_error("Failed to encode P-256 public key");
+
+	std::vector<unsigned char> der(len);
+	unsigned char *out = der.data();
+	i2d_PUBKEY(pkey, &out);
+
+	auto point = reinterpret_cast<const byte *>(der.data() + der.size() - (1 + 2 * P256_COORD_SIZE));
+	assert(point[0] == byte(0x04));
+	if (!compressed)
+		return binary(point, point + 1 + 2 * P256_COORD_SIZE);
+
+	binary output;
+	output.reserve(1 + P256_COORD_SIZE);
+	output.push_back(byte(0x02) | (point[2 * P256_COORD_SIZE] & byte(0x01))); // parity of y
+	output.insert(output.end(), point + 1, point + 1 + P256_COORD_SIZE);
+	return output;
+}
+
+void OpenSslRandom(byte *data, size_t size) {
+	if (RAND_bytes(reinterpret_cast<unsigned char *>(data), int(size)) != 1)
+		throw std::runtime_error("OpenSSL random generation failed");
+}
+
+} // namespace legio::impl
+
+#endif
@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_OPENSSL_H
+#define LEGIO_IMPL_OPENSSL_H
+
+#if LEGIO_USE_OPENSSL
+
+#include "common.hpp"
+
+#include <openssl/evp.h>
+
+namespace legio::impl {
+
+// Helpers shared by the OpenSSL crypto provider, enabled with the USE_OPENSSL CMake option
+
+// Generate a P-256 key pair
+EVP_PKEY *OpenSslGenerateP256();
+
+// Decode a compressed or uncompressed P-256 point, throws if it is not on the curve
+EVP_PKEY *OpenSslDecodeP256(binary_view point);
+
+// Encode the public point of a generated P-256 key
+binary OpenSslEncodeP256(EVP_PKEY *pkey, bool compressed);
+
+void OpenSslRandom(byte *data, size_t size);
+
+} // namespace legio::impl
+
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#if LEGIO_USE_OPENSSL
+
+#include "opensslaead.hpp"
+#include "openssl.hpp"
+
+#include <cstring>
+
+namespace legio::impl {
+
+namespace {
+
+const size_t IV_COUNTER_SIZE = 8;
+
+const EVP_CIPHER *GetCipher(CipherSuite suite, size_t keySize) {
+	switch (suite) {
+	case CipherSuite::AesGcm:
+		if (keySize == 16)
+			return EVP_aes_128_gcm();
+		if (keySize == 32)
+			return EVP_aes_256_gcm();
+		throw std::invalid_argument("Invalid AES key size");
+	case CipherSuite::ChaChaPoly:
+		if (keySize == 32)
+			return EVP_chacha20_poly1305();
+		throw std::invalid_argument("Invalid ChaCha20 key size");
+	default:
+		throw std::invalid_argument("Unknown cipher suite");
+	}
+}
+
+// Set up the cipher and key once, the IV is set for each message to keep the key schedule
+EVP_CIPHER_CTX *CreateContext(CipherSuite suite, const binary &key, bool encrypt) {
+	EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+	if (!ctx)
+		throw std::runtime_error("Failed to create OpenSSL cipher context");
+
+	const EVP_CIPHER *cipher = GetCipher(suite, key.size());
+	int ivSize = int(CipherSuiteNonceSize(suite));
+	auto keyData = reinterpret_cast<const unsigned char *>(key.data());
+	if (!EVP_CipherInit_ex(ctx, cipher, nullptr, nullptr, nullptr, encrypt ? 1 : 0) ||
+	    !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN, ivSize, nullptr) ||
+	    !EVP_CipherInit_ex(ctx, nullptr, nullptr, keyData, nullptr, encrypt ? 1 : 0)) {
+		EVP_CIPHER_CTX_free(ctx);
+		throw std::runtime_error("Failed to initialize OpenSSL cipher");
+	}
+
+	return ctx;
+}
+
+} // namespace
+
+OpenSslAeadEncryption::OpenSslAeadEncryption(CipherSuite suite, binary key)
+    : mSuite(suite), mContext(CreateContext(suite, key, true)), mIv(CipherSuiteNonceSize(suite)) {
+	// The IV is a random prefix chosen with the key followed by a message counter
+	OpenSslRandom(mIv.data(), mIv.size() - IV_COUNTER_SIZE);
+	std::memset(mIv.data() + mIv.size() - IV_COUNTER_SIZE, 0, IV_COUNTER_SIZE);
+}
+
+OpenSslAeadEncryption::~OpenSslAeadEncryption() { EVP_CIPHER_CTX_free(mContext); }
+
+CipherSuite OpenSslAeadEncryption::suite() const { return mSuite; }
+
+binary OpenSslAeadEncryption::iv() const { return mIv; }
+
+void OpenSslAeadEncryption::resynchronize() {
+	uint64_t counter = htonll(++mCounter);
+	std::memcpy(mIv.data() + mIv.size() - IV_COUNTER_SIZE, &counter, IV_COUNTER_SIZE);
+}
+
+void OpenSslAeadEncryption::encrypt(const byte *data, size_t size, byte *out, binary_view ad) {
+	auto input = reinterpret_cast<const unsigned char *>(data);
+	auto output = reinterpret_cast<unsigned char *>(out);
+	int len = 0;
+	if (!EVP_EncryptInit_ex(mContext, nullptr, nullptr, nullptr,
+	                        reinterpret_cast<const unsigned char *>(mIv.data())) ||
+	    (!ad.empty() && !EVP_EncryptUpdate(mContext, nullptr, &len,
+	                                       reinterpret_cast<const unsigned char *>(ad.data()),
+	                                       int(ad.size()))) ||
+	    !EVP_EncryptUpdate(mContext, output, &len, input, int(size)) ||
+	    !EVP_EncryptFinal_ex(mContext, output + len, &len) ||
+	    !EVP_CIPHER_CTX_ctrl(mContext, EVP_CTRL_AEAD_GET_TAG, int(TagSize), output + size))
+		throw std::runtime_error("OpenSSL encryption failed");
+}
+
+OpenSslAeadDecryption::OpenSslAeadDecryption(CipherSuite suite, binary key)
+    : mSuite(suite), mContext(CreateContext(suite, key, false)), mIv(CipherSuiteNonceSize(suite)) {}
+
+OpenSslAeadDecryption::~OpenSslAeadDecryption() { EVP_CIPHER_CTX_free(mContext); }
+
+CipherSuite OpenSslAeadDecryption::suite() const { return mSuite; }
+
+void OpenSslAeadDecryption::resynchronize(binary_view iv) {
+	if (iv.size() != mIv.size())
+		throw std::invalid_argument("Invalid IV size");
+
+	std::copy(iv.begin(), iv.end(), mIv.begin());
+}
+
+bool OpenSslAeadDecryption::decrypt(const byte *data, size_t size, byte *out, binary_view ad) {
+	if (size < TagSize)
+		return false;
+
+	size_t length = size - TagSize;
+	auto input = reinterpret_cast<const unsigned char *>(data);
+	auto output = reinterpret_cast<unsigned char *>(out);
+
+	// Copy the tag first as decryption may be in place
+	unsigned char tag[16];
+	std::memcpy(tag, input + length, TagSize);
+
+	int len = 0;
+	if (!EVP_DecryptInit_ex(mContext, nullptr, nullptr, nullptr,
+	                        reinterpret_cast<const unsigned char *>(mIv.data())) ||
+	    !EVP_CIPHER_CTX_ctrl(mContext, EVP_CTRL_AEAD_SET_TAG, int(TagSize), tag) ||
+	    (!ad.empty() && !EVP_DecryptUpdate(mContext, nullptr, &len,
+	                                       reinterpret_cast<const unsigned char *>(ad.data()),
+	                                       int(ad.size()))) ||
+	    !EVP_DecryptUpdate(mContext, output, &len, input, int(length)))
+		throw std::runtime_error("OpenSSL decryption failed");
+
+	return EVP_DecryptFinal_ex(mContext, output + len, &len) > 0;
+}
+
+} // namespace legio::impl
+
+#endif
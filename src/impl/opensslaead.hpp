@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_OPENSSL_AEAD_H
+#define LEGIO_IMPL_OPENSSL_AEAD_H
+
+#if LEGIO_USE_OPENSSL
+
+#include "common.hpp"
+#include "cipher.hpp"
+
+#include <openssl/evp.h>
+
+namespace legio::impl {
+
+// AEAD encryption with OpenSSL, same output and IV scheme as the Crypto++ implementations
+class OpenSslAeadEncryption final : public AeadEncryption {
+public:
+	OpenSslAeadEncryption(CipherSuite suite, binary key);
+	OpenSslAeadEncryption(const OpenSslAeadEncryption &) = delete;
+	~OpenSslAeadEncryption();
+
+	CipherSuite suite() const override;
+	binary iv() const override;
+
+	void resynchronize() override;
+
+	using AeadEncryption::encrypt;
+	void encrypt(const byte *data, size_t size, byte *out, binary_view ad = {}) override;
+
+private:
+	const CipherSuite mSuite;
+	EVP_CIPHER_CTX *mContext;
+	binary mIv;
+	uint64_t mCounter = 0;
+};
+
+// AEAD decryption with OpenSSL
+class OpenSslAeadDecryption final : public AeadDecryption {
+public:
+	OpenSslAeadDecryption(CipherSuite suite, binary key);
+	OpenSslAeadDecryption(const OpenSslAeadDecryption &) = delete;
+	~OpenSslAeadDecryption();
+
+	CipherSuite suite() const override;
+
+	void resynchronize(binary_view iv) override;
+
+	using AeadDecryption::decrypt;
+	bool decrypt(const byte *data, size_t size, byte *out, binary_view ad = {}) override;
+
+private:
+	const CipherSuite mSuite;
+	EVP_CIPHER_CTX *mContext;
+	binary mIv;
+};
+
+} // namespace legio::impl
+
+#endif
+
+#endif
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#if LEGIO_USE_OPENSSL
+
+#include "opensslecdsa.hpp"
+#include "openssl.hpp"
+
+#include <openssl/ecdsa.h>
+
+#include <vector>
+
+namespace legio::impl {
+
+namespace {
+
+const size_t KEY_SIZE = 33; // compressed point, as for EcdsaPublic
+
+// Signatures are the concatenation of r and s like Crypto++, whereas OpenSSL uses DER
+const size_t SIGNATURE_COORD_SIZE = 32;
+
+using md_ctx_ptr = std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)>;
+using ecdsa_sig_ptr = std::unique_ptr<ECDSA_SIG, decltype(&ECDSA_SIG_free)>;
+
+md_ctx_ptr NewMdContext() {
+	md_ctx_ptr ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+	if (!ctx)
+		throw std::runtime_error("Failed to create OpenSSL digest context");
+
+	return ctx;
+}
+
+} // namespace
+
+OpenSslEcdsaPublic::OpenSslEcdsaPublic(binary_view key) : mKey(to_binary(key)) {
+	if (mKey.size() != KEY_SIZE)
+		throw std::invalid_argument("Invalid ECDSA public key size");
+
+	mPublicKey = OpenSslDecodeP256(mKey);
+}
+
+OpenSslEcdsaPublic::~OpenSslEcdsaPublic() { EVP_PKEY_free(mPublicKey); }
+
+binary OpenSslEcdsaPublic::publicKey() const { return mKey; }
+
+bool OpenSslEcdsaPublic::verify(const byte *message, size_t size, binary_view signature) const {
+	if (signature.size() != 2 * SIGNATURE_COORD_SIZE)
+		return false;
+
+	auto sigData = reinterpret_cast<const unsigned char *>(signature.data());
+	ecdsa_sig_ptr sig(ECDSA_SIG_new(), ECDSA_SIG_free);
+	BIGNUM *r = BN_bin2bn(sigData, int(SIGNATURE_COORD_SIZE), nullptr);
+	BIGNUM *s = BN_bin2bn(sigData + SIGNATURE_COORD_SIZE, int(SIGNATURE_COORD_SIZE), nullptr);
+	if (!sig || !r || !s || !ECDSA_SIG_set0(sig.get(), r, s)) {
+		BN_free(r);
+		BN_free(s);
+		throw std::runtime_error("Failed to create OpenSSL ECDSA signature");
+	}
+
+	unsigned char *der = nullptr;
+	int derSize = i2d_ECDSA_SIG(sig.get(), &der);
+	if (derSize <= 0)
+		throw std::runtime_error("Failed to encode OpenSSL ECDSA signature");
+
+	// The key is only read, so concurrent verifications with their own context are safe
+	auto ctx = NewMdContext();
+	int result = EVP_DigestVerifyInit(ctx.get(), nullptr, EVP_sha256(), nullptr, mPublicKey) > 0
+	                 ? EVP_DigestVerify(ctx.get(), der, size_t(derSize),
+	                                    reinterpret_cast<const unsigned char *>(message), size)
+	                 : -1;
+	OPENSSL_free(der);
+	return result == 1;
+}
+
+OpenSslEcdsaPair::OpenSslEcdsaPair() : mPrivateKey(OpenSslGenerateP256()) {
+	mPublic = std::make_shared<const OpenSslEcdsaPublic>(OpenSslEncodeP256(mPrivateKey, true));
+}
+
+OpenSslEcdsaPair::~OpenSslEcdsaPair() { EVP_PKEY_free(mPrivateKey); }
+
+shared_ptr<const PublicKey> OpenSslEcdsaPair::publicPart() const { return mPublic; }
+
+binary OpenSslEcdsaPair::sign(const byte *message, size_t size) const {
+	// Nonces are random, OpenSSL holds no signer state so no lock is needed
+	auto ctx = NewMdContext();
+	size_t derSize = 0;
+	auto input = reinterpret_cast<const unsigned char *>(message);
+	if (EVP_DigestSignInit(ctx.get(), nullptr, EVP_sha256(), nullptr, mPrivateKey) <= 0 ||
+	    EVP_DigestSign(ctx.get(), nullptr, &derSize, input, size) <= 0)
+		throw std::runtime_error("OpenSSL ECDSA signing failed");
+
+	std::vector<unsigned char> der(derSize);
+	if (EVP_DigestSign(ctx.get(), der.data(), &derSize, input, size) <= 0)
+		throw std::runtime_error("OpenSSL ECDSA signing failed");
+
+	const unsigned char *in = der.data();
+	ecdsa_sig_ptr sig(d2i_ECDSA_SIG(nullptr, &in, long(derSize)), ECDSA_SIG_free);
+	if (!sig)
+		throw std::runtime_error("Failed to decode OpenSSL ECDSA signature");
+
+	binary signature(2 * SIGNATURE_COORD_SIZE);
+	auto out = reinterpret_cast<unsigned char *>(signature.data());
+	if (BN_bn2binpad(ECDSA_SIG_get0_r(sig.get()), out, int(SIGNATURE_COORD_SIZE)) < 0 ||
+	    BN_bn2binpad(ECDSA_SIG_get0_s(sig.get()), out + SIGNATURE_COORD_SIZE,
+	                 int(SIGNATURE_COORD_SIZE)) < 0)
+		throw std::runtime_error("Failed to encode ECDSA signature");
+
+	return signature;
+}
+
+} // namespace legio::impl
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_OPENSSL_ECDSA_H
+#define LEGIO_IMPL_OPENSSL_ECDSA_H
+
+#if LEGIO_USE_OPENSSL
+
+#include "common.hpp"
+#include "keys.hpp"
+
+#include <openssl/evp.h>
+
+namespace legio::impl {
+
+// ECDSA P-256 public key with OpenSSL, same encoding and signature format as EcdsaPublic
+class OpenSslEcdsaPublic final : public PublicKey {
+public:
+	OpenSslEcdsaPublic(binary_view key);
+	OpenSslEcdsaPublic(const OpenSslEcdsaPublic &) = delete;
+	~OpenSslEcdsaPublic();
+
+	KeyType type() const override { return KeyType::P256; }
+
+	binary publicKey() const override;
+
+	using PublicKey::verify;
+	bool verify(const byte *message, size_t size, binary_view signature) const override;
+
+private:
+	binary mKey;
+	EVP_PKEY *mPublicKey;
+};
+
+// ECDSA P-256 key pair with OpenSSL, signatures are verifiable by EcdsaPublic and vice versa
+class OpenSslEcdsaPair final : public KeyPair {
+public:
+	OpenSslEcdsaPair();
+	OpenSslEcdsaPair(const OpenSslEcdsaPair &) = delete;
+	~OpenSslEcdsaPair();
+
+	KeyType type() const override { return KeyType::P256; }
+	shared_ptr<const PublicKey> publicPart() const override;
+
+	using KeyPair::sign;
+	binary sign(const byte *message, size_t size) const override;
+
+private:
+	EVP_PKEY *mPrivateKey;
+	shared_ptr<const OpenSslEcdsaPublic> mPublic;
+};
+
+} // namespace legio::impl
+
+#endif
+
+#endif
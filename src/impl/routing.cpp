@@ -19,17 +19,53 @@
 #include "routing.hpp"
 #include "node.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <string_view>
+#include <thread>
 
 namespace legio::impl {
 
-Routing::Routing(Node *node) : Component(node), mTable(std::make_shared<RoutingTable>()) {}
+const size_t VerificationQueueSize = 65536;
+
+namespace {
+
+unsigned default_verification_threads() {
+#ifdef __EMSCRIPTEN__
+	return 0; // verify synchronously
+#else
+	return std::max(std::thread::hardware_concurrency(), 1u);
+#endif
+}
+
+size_t source_key(const Message::Envelope &envelope) {
+	auto source = *envelope.source;
+	return std::hash<std::string_view>()(
+	    std::string_view(reinterpret_cast<const char *>(source.data()), source.size()));
+}
+
+} // namespace
+
+Routing::Routing(Node *node)
+    : Component(node),
+      mIngress(std::make_shared<Ingress>(
+          node->config.verificationRate.value_or(DefaultVerificationRate),
+          node->config.verificationBurst.value_or(DefaultVerificationBurst))),
+      mFragmentation(std::make_shared<Fragmentation>()),
+      mCoalescing(std::make_shared<Coalescing>(node->scheduler.get(), mFragmentation,
+                                               node->config.coalescingDelay)),
+      mTable(std::make_shared<RoutingTable>()),
+      mVerificationPool(std::make_unique<ThreadPool>(
+          node->config.verificationThreads.value_or(default_verification_threads()),
+          VerificationQueueSize)) {}
 
 Routing::~Routing() {}
 
+void Routing::shutdown() { mVerificationPool->join(); }
+
 Identifier Routing::localId() const { return node()->id(); }
 
-void Routing::update() {}
+void Routing::update() { mFragmentation->expire(); }
 
 void Routing::notify(const events::variant &event) {}
 
@@ -40,11 +76,31 @@ void Routing::addChannel(shared_ptr<Channel> channel) {
 	    [this, channel](rtc::binary data) {
 		    // This can be called on non-main thread
 		    try {
-			    auto message = std::make_shared<Message>(data);
-			    route(std::move(message), channel);
+			    auto &pool = BufferPool::Instance();
+
+			    // Frames larger than the channel maximum message size arrive in fragments
+			    if (Fragmentation::IsFragment(data)) {
+				    auto frame = mFragmentation->reassemble(channel.get(), data);
+				    if (!frame)
+					    return; // incomplete or dropped
+
+				    pool.recycle(std::move(data));
+				    data = std::move(*frame);
+			    }
+
+			    // Small frames might arrive coalesced in a batch
+			    if (Coalescing::IsBatch(data)) {
+				    mCoalescing->unpack(data, [this, &pool, &channel](binary_view frame) {
+					    incoming(channel, pool.copy(frame));
+				    });
+				    pool.recycle(std::move(data));
+				    return;
+			    }
+
+			    incoming(channel, std::move(data));
 
 		    } catch (const std::exception &e) {
-			    std::cerr << "Invalid message: " << e.what() << std::endl;
+			    std::cerr << "Dropping invalid frame: " << e.what() << std::endl;
 		    }
 	    },
 	    [](rtc::string data) { std::cerr << "Unexpected non-binary message" << std::endl; });
@@ -52,9 +108,53 @@ void Routing::addChannel(shared_ptr<Channel> channel) {
 	mChannels.emplace(std::move(channel));
 }
 
+void Routing::incoming(shared_ptr<Channel> channel, binary data) {
+	try {
+		// Keep the frame so forwarding can reuse it as is
+		auto wire = BufferPool::Instance().share(std::move(data));
+		auto envelope = mIngress->peek(*wire);
+		if (!envelope)
+			return; // malformed
+
+		if (forward(wire, *envelope, channel.get()))
+			return; // transit message
+
+		if (!mIngress->filter(*envelope, channel.get()))
+			return;
+
+#ifdef __EMSCRIPTEN__
+		// Verify with WebCrypto without blocking the event loop
+		mIngress->verifyAsync(std::move(wire), *envelope, [this, channel](message_ptr message) {
+			if (message)
+				route(std::move(message), channel);
+		});
+#else
+		// Verify on the pool, messages from the same source are kept in order
+		auto task = [this, wire = std::move(wire), envelope = *envelope, channel]() {
+			if (auto message = mIngress->verify(wire, envelope))
+				route(std::move(message), channel);
+		};
+		if (mVerificationPool->tryEnqueue(source_key(*envelope), std::move(task))) {
+			mVerificationQueueFull = false; // report again on the next overflow
+		} else {
+			++mVerificationDropped;
+			if (!mVerificationQueueFull.exchange(true))
+				std::cerr << "Verification queue is full, dropping messages" << std::endl;
+		}
+#endif
+
+	} catch (const std::exception &e) {
+		std::cerr << "Invalid message: " << e.what() << std::endl;
+	}
+}
+
 void Routing::removeChannel(shared_ptr<Channel> channel) {
 	std::unique_lock lock(mMutex);
 
+	mIngress->removeChannel(channel.get());
+	mFragmentation->removeChannel(channel.get());
+	mCoalescing->removeChannel(channel.get());
+
 	// Remove channel
 	if (auto it = mChannels.find(channel); it != mChannels.end()) {
 		auto channel = *it;
@@ -117,20 +217,38 @@ void Routing::setTable(shared_ptr<RoutingTable> routingTable) {
 	mTable = std::move(routingTable);
 }
 
+Ingress::Counters Routing::ingressCounters() const { return mIngress->counters(); }
+
+BufferPool::Stats Routing::bufferStats() const { return BufferPool::Instance().stats(); }
+
+Fragmentation::Counters Routing::fragmentationCounters() const {
+	return mFragmentation->counters();
+}
+
+Coalescing::Counters Routing::coalescingCounters() const { return mCoalescing->counters(); }
+
+size_t Routing::verificationThreads() const { return mVerificationPool->size(); }
+
+size_t Routing::verificationQueueDepth() const { return mVerificationPool->queueDepth(); }
+
+uint64_t Routing::verificationDropped() const { return mVerificationDropped.load(); }
+
 void Routing::send(message_ptr message) {
-	if (message->destination)
+	if (message->destination || message->multicast)
 		route(message, nullptr);
 	else
 		broadcast(message);
 }
 
 void Routing::broadcast(message_ptr message, shared_ptr<Channel> from) {
+	auto wire = message->wire(); // serialize once for all channels
+
 	std::unique_lock lock(mMutex);
 
 	for (const auto &channel : mChannels) {
 		if (channel != from && channel->isOpen()) {
 			try {
-				channel->send(binary(*message));
+				mCoalescing->send(channel, *wire);
 			} catch (const std::exception &e) {
 				std::cerr << e.what() << std::endl;
 			}
@@ -138,18 +256,85 @@ void Routing::broadcast(message_ptr message, shared_ptr<Channel> from) {
 	}
 }
 
+bool Routing::forward(shared_ptr<const binary> wire, const Message::Envelope &envelope,
+                      const Channel *from) {
+	// Cut-through forwarding: transit unicast messages are only peeked, filtered by type and rate,
+	// and sent untouched, they are decoded and verified at destination
+	if (!envelope.source || !envelope.destination)
+		return false;
+
+	Identifier destination(*envelope.destination);
+	if (destination == localId())
+		return false;
+
+	if (!mIngress->filterTransit(envelope, from))
+		return true; // dropped
+
+	if (auto channel = findRoute(destination))
+		mCoalescing->send(channel, *wire);
+
+	return true;
+}
+
 void Routing::route(message_ptr message, shared_ptr<Channel> from) {
 	if (!message->source)
 		throw std::runtime_error("Missing message source");
 
+	if (message->multicast) {
+		routeMulticast(std::move(message), from);
+		return;
+	}
+
 	if (!message->destination || *message->destination == localId()) {
 		emit(events::Message{message, from});
 	} else {
-		if (auto channel = findRoute(*message->destination))
-			channel->send(binary(*message));
+		if (auto channel = findRoute(*message->destination)) {
+			// Unless already serialized, the frame is flattened for this send only and moved
+			if (auto wire = message->cachedWire())
+				mCoalescing->send(channel, *wire);
+			else
+				mCoalescing->send(channel, binary(*message));
+		}
 	}
 }
 
+void Routing::routeMulticast(message_ptr message, shared_ptr<Channel> from) {
+	// Group the recipients by next hop, the message is only split where routes diverge
+	MulticastBody body(message->body);
+	Identifier local = localId();
+	bool isRecipient = false;
+	std::unordered_map<shared_ptr<Channel>, std::vector<MulticastBody::Recipient>> hops;
+	for (auto &recipient : body.recipients) {
+		if (recipient.id == local)
+			isRecipient = true;
+		else if (auto channel = findRoute(recipient.id))
+			hops[channel].push_back(std::move(recipient));
+	}
+
+	for (auto &[channel, recipients] : hops) {
+		if (hops.size() == 1 && !isRecipient && recipients.size() == body.recipients.size()) {
+			// No split, send untouched
+			if (auto wire = message->cachedWire())
+				mCoalescing->send(channel, *wire);
+			else
+				mCoalescing->send(channel, binary(*message));
+
+			continue;
+		}
+
+		// Lend the ciphertext to the part for serialization instead of copying it
+		MulticastBody part(body.suite, body.iv, std::move(body.ciphertext));
+		part.recipients = std::move(recipients);
+		auto split = Message::CreateMulticast(message->type, message->sequence, binary(part),
+		                                      *message->source);
+		body.ciphertext = std::move(part.ciphertext);
+		mCoalescing->send(channel, binary(split));
+	}
+
+	if (isRecipient)
+		emit(events::Message{message, from});
+}
+
 shared_ptr<Channel> Routing::findRoute(const Identifier &remoteId) {
 	std::shared_lock lock(mMutex);
 	if (!mTable)
@@ -159,7 +344,7 @@ shared_ptr<Channel> Routing::findRoute(const Identifier &remoteId) {
 	if (!nextHop)
 		return nullptr; // missing next hop
 
-	auto it = mNeighbors.find(remoteId);
+	auto it = mNeighbors.find(*nextHop);
 	if (it == mNeighbors.end())
 		return nullptr; // missing channel for next hop
 
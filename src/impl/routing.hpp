@@ -20,12 +20,17 @@
 #define LEGIO_IMPL_ROUTING_H
 
 #include "common.hpp"
+#include "coalescing.hpp"
 #include "component.hpp"
+#include "fragmentation.hpp"
+#include "ingress.hpp"
 #include "message.hpp"
 #include "routingtable.hpp"
+#include "threadpool.hpp"
 
 #include <rtc/channel.hpp>
 
+#include <atomic>
 #include <set>
 #include <shared_mutex>
 #include <unordered_map>
@@ -40,6 +45,9 @@ public:
 	Routing(Node *node);
 	~Routing();
 
+	// Join pending verifications, which route to other components
+	void shutdown();
+
 	Identifier localId() const;
 
 	void update() override;
@@ -59,14 +67,35 @@ public:
 	shared_ptr<RoutingTable> table() const;
 	void setTable(shared_ptr<RoutingTable> table);
 
+	Ingress::Counters ingressCounters() const;
+	BufferPool::Stats bufferStats() const;
+	Fragmentation::Counters fragmentationCounters() const;
+	Coalescing::Counters coalescingCounters() const;
+	size_t verificationThreads() const;
+	size_t verificationQueueDepth() const;
+	uint64_t verificationDropped() const;
+
 private:
+	void incoming(shared_ptr<Channel> channel, binary data);
+	bool forward(shared_ptr<const binary> wire, const Message::Envelope &envelope,
+	             const Channel *from);
 	void route(message_ptr message, shared_ptr<Channel> from);
+	void routeMulticast(message_ptr message, shared_ptr<Channel> from);
 	shared_ptr<Channel> findRoute(const Identifier &destination);
 
+	const shared_ptr<Ingress> mIngress;
+	const shared_ptr<Fragmentation> mFragmentation;
+	const shared_ptr<Coalescing> mCoalescing;
 	shared_ptr<RoutingTable> mTable;
 	std::unordered_set<shared_ptr<Channel>> mChannels;
 	std::unordered_map<Identifier, shared_ptr<Channel>, Identifier::hash> mNeighbors;
 	mutable std::shared_mutex mMutex;
+
+	std::atomic<uint64_t> mVerificationDropped = 0;
+	std::atomic<bool> mVerificationQueueFull = false;
+
+	// Last so that pending verifications are joined first on destruction
+	const unique_ptr<ThreadPool> mVerificationPool;
 };
 
 } // namespace legio::impl
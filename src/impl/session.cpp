@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "session.hpp"
+#include "bufferpool.hpp"
+#include "sha.hpp"
+
+#include <algorithm>
+
+namespace legio::impl {
+
+binary Session::DeriveKey(const binary &agreed, CipherSuite suite, const binary &senderPublicKey,
+                          const binary &receiverPublicKey) {
+	binary material = agreed;
+	material.push_back(byte(suite));
+	material.insert(material.end(), senderPublicKey.begin(), senderPublicKey.end());
+	material.insert(material.end(), receiverPublicKey.begin(), receiverPublicKey.end());
+	return Sha256(material);
+}
+
+Session::Session(const Ecdh &localEcdh, binary remotePublicKey, CipherSuite suite)
+    : mLocalPublicKey(localEcdh.publicKey()), mRemotePublicKey(std::move(remotePublicKey)) {
+	binary agreed = localEcdh.agree(mRemotePublicKey);
+	mEncryption = AeadEncryption::Create(
+	    suite, DeriveKey(agreed, suite, mLocalPublicKey, mRemotePublicKey));
+	mDecryption = AeadDecryption::Create(
+	    suite, DeriveKey(agreed, suite, mRemotePublicKey, mLocalPublicKey));
+}
+
+Session::~Session() {}
+
+const binary &Session::localPublicKey() const { return mLocalPublicKey; }
+
+const binary &Session::remotePublicKey() const { return mRemotePublicKey; }
+
+CipherSuite Session::suite() const { return mEncryption->suite(); }
+
+std::pair<binary, binary> Session::encrypt(binary_view cleartext, binary_view ad) {
+	binary ciphertext = BufferPool::Instance().take(cleartext.size() + AeadEncryption::TagSize);
+	ciphertext.resize(cleartext.size() + AeadEncryption::TagSize);
+	binary iv = encrypt(cleartext, ciphertext.data(), ad);
+	return std::make_pair(std::move(iv), std::move(ciphertext));
+}
+
+binary Session::encrypt(binary_view cleartext, byte *out, binary_view ad) {
+	std::lock_guard lock(mEncryptionMutex);
+	mEncryption->resynchronize();
+	mEncryption->encrypt(cleartext.data(), cleartext.size(), out, ad);
+	return mEncryption->iv();
+}
+
+void Session::decrypt(binary_view iv, binary &data, binary_view ad) {
+	std::lock_guard lock(mDecryptionMutex);
+	mDecryption->resynchronize(iv);
+	mDecryption->decryptInPlace(data, ad);
+}
+
+const size_t SessionCache::DefaultCapacity = 1024;
+
+SessionCache::SessionCache(size_t capacity) : mCapacity(std::max(capacity, size_t(1))) {}
+
+SessionCache::~SessionCache() {}
+
+shared_ptr<Session> SessionCache::get(const Ecdh &localEcdh, const binary &remotePublicKey,
+                                      CipherSuite suite) {
+	binary key = localEcdh.publicKey() + remotePublicKey;
+	key.push_back(byte(suite));
+	{
+		std::lock_guard lock(mMutex);
+		if (auto it = mIndex.find(key); it != mIndex.end()) {
+			mEntries.splice(mEntries.begin(), mEntries, it->second);
+			return it->second->second;
+		}
+	}
+
+	// Derive the shared key outside the lock
+	auto session = std::make_shared<Session>(localEcdh, remotePublicKey, suite);
+
+	std::lock_guard lock(mMutex);
+	if (auto it = mIndex.find(key); it != mIndex.end())
+		return it->second->second; // concurrently inserted
+
+	mEntries.emplace_front(key, session);
+	mIndex.emplace(std::move(key), mEntries.begin());
+
+	while (mIndex.size() > mCapacity) {
+		mIndex.erase(mEntries.back().first);
+		mEntries.pop_back();
+	}
+
+	return session;
+}
+
+void SessionCache::invalidate(const binary &remotePublicKey) {
+	std::lock_guard lock(mMutex);
+	auto it = mEntries.begin();
+	while (it != mEntries.end()) {
+		if (it->second->remotePublicKey() == remotePublicKey) {
+			mIndex.erase(it->first);
+			it = mEntries.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void SessionCache::clear() {
+	std::lock_guard lock(mMutex);
+	mIndex.clear();
+	mEntries.clear();
+}
+
+} // namespace legio::impl
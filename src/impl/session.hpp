@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_SESSION_H
+#define LEGIO_IMPL_SESSION_H
+
+#include "common.hpp"
+#include "cipher.hpp"
+#include "ecdh.hpp"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace legio::impl {
+
+// Encryption session between a local and a remote ECDH key, a key per direction is derived once
+class Session final {
+public:
+	// Each direction has its own key, bound to the sender and receiver public keys in this order
+	static binary DeriveKey(const binary &agreed, CipherSuite suite, const binary &senderPublicKey,
+	                        const binary &receiverPublicKey);
+
+	Session(const Ecdh &localEcdh, binary remotePublicKey, CipherSuite suite);
+	~Session();
+
+	const binary &localPublicKey() const;
+	const binary &remotePublicKey() const;
+	CipherSuite suite() const;
+
+	// Encrypt with the next IV, returns the IV and the ciphertext followed by the tag
+	std::pair<binary, binary> encrypt(binary_view cleartext, binary_view ad = {});
+	// Encrypt to out, which must hold the size of the cleartext plus the tag, returns the IV
+	binary encrypt(binary_view cleartext, byte *out, binary_view ad = {});
+	// Decrypt in place, data holds the ciphertext followed by the tag and is truncated
+	void decrypt(binary_view iv, binary &data, binary_view ad = {});
+
+private:
+	const binary mLocalPublicKey;
+	const binary mRemotePublicKey;
+
+	unique_ptr<AeadEncryption> mEncryption;
+	unique_ptr<AeadDecryption> mDecryption;
+	std::mutex mEncryptionMutex;
+	std::mutex mDecryptionMutex;
+};
+
+// Bounded cache of sessions indexed by local and remote ECDH public keys and cipher suite
+class SessionCache final {
+public:
+	static const size_t DefaultCapacity;
+
+	SessionCache(size_t capacity = DefaultCapacity);
+	~SessionCache();
+
+	shared_ptr<Session> get(const Ecdh &localEcdh, const binary &remotePublicKey,
+	                        CipherSuite suite);
+	void invalidate(const binary &remotePublicKey);
+	void clear();
+
+private:
+	using Entry = std::pair<binary, shared_ptr<Session>>;
+	using iterator = std::list<Entry>::iterator;
+
+	const size_t mCapacity;
+	std::list<Entry> mEntries; // most recently used first
+	std::unordered_map<binary, iterator, binary_hash> mIndex;
+	std::mutex mMutex;
+};
+
+} // namespace legio::impl
+
+#endif
@@ -18,16 +18,27 @@
 
 #include "sha.hpp"
 
+#if LEGIO_USE_OPENSSL
+#include <openssl/sha.h>
+#else
 #include "cryptopp/sha.h"
+#endif
 
 namespace legio::impl {
 
 binary Sha256(const binary &input) {
+#if LEGIO_USE_OPENSSL
+	binary output(SHA256_DIGEST_LENGTH);
+	SHA256(reinterpret_cast<const unsigned char *>(input.data()), input.size(),
+	       reinterpret_cast<unsigned char *>(output.data()));
+	return output;
+#else
 	CryptoPP::SHA256 hash;
 	hash.Update(reinterpret_cast<const CryptoPP::byte *>(input.data()), input.size());
 	binary output(hash.DigestSize());
 	hash.Final(reinterpret_cast<CryptoPP::byte *>(output.data()));
 	return output;
+#endif
 }
 
 } // namespace legio::impl
@@ -17,26 +17,35 @@
  */
 
 #include "state.hpp"
-#include "ecdh.hpp" // for Ecdh::KeySize
+#include "ecdh.hpp" // for Ecdh::KeySize()
 
 #include <iostream>
 
 namespace legio::impl {
 
-State::State(EcdsaPublic _ecdsaPublic, uint32_t _sequence, binary _ecdhPublic)
-    : ecdsaPublic(std::move(_ecdsaPublic)), sequence(_sequence), ecdhPublic(std::move(_ecdhPublic)) {}
+State::State(Identifier _identifier, uint32_t _sequence, std::vector<binary> _ecdhPublicKeys,
+             cipher_suites _ciphers)
+    : identifier(std::move(_identifier)), sequence(_sequence),
+      ecdhPublicKeys(std::move(_ecdhPublicKeys)), ciphers(std::move(_ciphers)) {}
 
 State::~State() {}
 
-message_ptr State::toMessage(const EcdsaPair &ecdsaPair) const {
+message_ptr State::toMessage(const KeyPair &keyPair) const {
 	binary_writer writer;
 
-	writer.write(ecdhPublic);
+	uint8_t keyCount = uint8_t(ecdhPublicKeys.size());
+	writer.write(reinterpret_cast<const byte *>(&keyCount), 1);
+	for (const binary &key : ecdhPublicKeys)
+		writer.write(key);
+
+	uint8_t count = uint8_t(ciphers.size());
+	writer.write(reinterpret_cast<const byte *>(&count), 1);
+	writer.write(reinterpret_cast<const byte *>(ciphers.data()), count);
 
 	for (const Identifier &id : neighbors)
-		writer.write(id);
+		writer.write(id.view());
 
-	return make_message(Message::State, sequence, std::move(writer.data()), ecdsaPair);
+	return make_message(Message::State, sequence, std::move(writer.data()), keyPair);
 }
 
 State State::FromMessage(message_ptr message) {
@@ -45,17 +54,35 @@ State State::FromMessage(message_ptr message) {
 
 	binary_reader reader(message->body);
 
-	if (reader.size() < Ecdh::KeySize)
+	uint8_t keyCount = 0;
+	reader.read(reinterpret_cast<byte *>(&keyCount), 1);
+	if (keyCount == 0)
+		throw std::invalid_argument("Missing ECDH public key in State message");
+
+	std::vector<binary> ecdhPublicKeys;
+	ecdhPublicKeys.reserve(keyCount);
+	for (uint8_t i = 0; i < keyCount; ++i) {
+		size_t keySize = Ecdh::KeySize(reader.leftView());
+		if (reader.size() < keySize + 1)
+			throw std::invalid_argument("Truncated State message");
+
+		ecdhPublicKeys.push_back(reader.read(keySize));
+	}
+
+	uint8_t count = 0;
+	reader.read(reinterpret_cast<byte *>(&count), 1);
+	if (reader.size() < count)
 		throw std::invalid_argument("Truncated State message");
 
-	binary ecdhPublic = reader.read(Ecdh::KeySize);
+	// Unknown suites are kept, they are simply never negotiated
+	cipher_suites ciphers(count);
+	reader.read(reinterpret_cast<byte *>(ciphers.data()), count);
 
-	State result(*message->source, message->sequence, std::move(ecdhPublic));
+	State result(*message->source, message->sequence, std::move(ecdhPublicKeys),
+	             std::move(ciphers));
 
-	while (reader.size() >= Identifier::Size) {
-		binary id = reader.read(Identifier::Size);
-		result.neighbors.insert(std::move(id));
-	}
+	while (reader.size() >= Identifier::Size)
+		result.neighbors.emplace(reader.readView(Identifier::Size));
 
 	if (reader.size() > 0)
 		std::cerr << "Warning: " << reader.size() << " bytes left in State message" << std::endl;
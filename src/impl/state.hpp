@@ -20,28 +20,31 @@
 #define LEGIO_IMPL_STATE_H
 
 #include "common.hpp"
-#include "ecdsa.hpp"
+#include "cipher.hpp"
 #include "identifier.hpp"
+#include "keys.hpp"
 #include "message.hpp"
 
 #include <set>
+#include <vector>
 
 namespace legio::impl {
 
 struct State final {
-	State(EcdsaPublic _ecdsaPublic, uint32_t _sequence, binary _ecdhPublic);
+	State(Identifier _identifier, uint32_t _sequence, std::vector<binary> _ecdhPublicKeys,
+	      cipher_suites _ciphers = LocalCipherSuites());
 	~State();
 
-	inline Identifier id() const { return Identifier(ecdsaPublic); }
-	inline const EcdsaPublic &publicKey() const { return ecdsaPublic; }
+	inline const Identifier &id() const { return identifier; }
 
-	message_ptr toMessage(const EcdsaPair &ecdsaPair) const;
+	message_ptr toMessage(const KeyPair &keyPair) const;
 	static State FromMessage(message_ptr message);
 
-	EcdsaPublic ecdsaPublic;
+	Identifier identifier;
 	uint32_t sequence;
 
-	binary ecdhPublic;
+	std::vector<binary> ecdhPublicKeys; // one per key type, by order of preference
+	cipher_suites ciphers;              // by order of preference
 	std::set<Identifier> neighbors;
 };
 
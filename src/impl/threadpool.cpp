@@ -0,0 +1,125 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "threadpool.hpp"
+
+#include <iostream>
+
+namespace legio::impl {
+
+ThreadPool::ThreadPool(size_t threads, size_t maxQueueSize)
+    : mMaxWorkerQueueSize(threads > 0 ? std::max((maxQueueSize + threads - 1) / threads, size_t(1))
+                                      : 0) {
+	mWorkers.reserve(threads);
+	for (size_t i = 0; i < threads; ++i) {
+		auto worker = std::make_unique<Worker>();
+		worker->thread = std::thread(&ThreadPool::run, this, std::ref(*worker));
+		mWorkers.push_back(std::move(worker));
+	}
+}
+
+ThreadPool::~ThreadPool() { join(); }
+
+size_t ThreadPool::size() const { return mWorkers.size(); }
+
+size_t ThreadPool::queueDepth() const {
+	size_t depth = 0;
+	for (const auto &worker : mWorkers) {
+		std::lock_guard lock(worker->mutex);
+		depth += worker->queue.size();
+	}
+	return depth;
+}
+
+bool ThreadPool::tryEnqueue(size_t key, Task task) {
+	if (mWorkers.empty()) {
+		task();
+		return true;
+	}
+
+	return push(*mWorkers[key % mWorkers.size()], std::move(task), false);
+}
+
+void ThreadPool::enqueue(size_t key, Task task) {
+	if (mWorkers.empty()) {
+		task();
+		return;
+	}
+
+	// Only fails once joining, the task would be dropped otherwise
+	if (!push(*mWorkers[key % mWorkers.size()], std::move(task), true))
+		throw std::runtime_error("Thread pool is shutting down");
+}
+
+void ThreadPool::join() {
+	for (auto &worker : mWorkers) {
+		{
+			std::lock_guard lock(worker->mutex);
+			worker->joining = true;
+		}
+		worker->tasksCondition.notify_all();
+		worker->spaceCondition.notify_all();
+	}
+
+	for (auto &worker : mWorkers)
+		if (worker->thread.joinable())
+			worker->thread.join();
+}
+
+bool ThreadPool::push(Worker &worker, Task task, bool wait) {
+	std::unique_lock lock(worker.mutex);
+	if (wait)
+		worker.spaceCondition.wait(lock, [&]() {
+			return worker.joining || worker.queue.size() < mMaxWorkerQueueSize;
+		});
+
+	if (worker.joining || worker.queue.size() >= mMaxWorkerQueueSize)
+		return false;
+
+	worker.queue.push_back(std::move(task));
+	lock.unlock();
+	worker.tasksCondition.notify_one();
+	return true;
+}
+
+void ThreadPool::run(Worker &worker) {
+	std::deque<Task> batch;
+	while (true) {
+		{
+			std::unique_lock lock(worker.mutex);
+			worker.tasksCondition.wait(lock,
+			                           [&]() { return worker.joining || !worker.queue.empty(); });
+			if (worker.queue.empty())
+				break; // joining
+
+			std::swap(batch, worker.queue);
+		}
+		worker.spaceCondition.notify_all();
+
+		for (auto &task : batch) {
+			try {
+				task();
+			} catch (const std::exception &e) {
+				std::cerr << "Unhandled exception in worker task: " << e.what() << std::endl;
+			}
+		}
+		batch.clear();
+	}
+}
+
+} // namespace legio::impl
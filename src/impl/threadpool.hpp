@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_THREADPOOL_H
+#define LEGIO_IMPL_THREADPOOL_H
+
+#include "common.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace legio::impl {
+
+// Pool of workers with keyed ordering: tasks sharing the same key always run on the same worker,
+// in submission order. Each worker runs its pending tasks in batches.
+// With zero threads, tasks are run synchronously by the caller.
+class ThreadPool final {
+public:
+	using Task = std::function<void()>;
+
+	ThreadPool(size_t threads, size_t maxQueueSize);
+	~ThreadPool();
+
+	size_t size() const;
+	size_t queueDepth() const;
+
+	// Returns false if the queue is full, in which case the task is dropped
+	bool tryEnqueue(size_t key, Task task);
+	// Blocks while the queue is full, throws if the pool is shutting down
+	void enqueue(size_t key, Task task);
+
+	void join();
+
+private:
+	struct Worker {
+		std::deque<Task> queue;
+		std::thread thread;
+		mutable std::mutex mutex;
+		std::condition_variable tasksCondition;
+		std::condition_variable spaceCondition;
+		bool joining = false;
+	};
+
+	bool push(Worker &worker, Task task, bool wait);
+	void run(Worker &worker);
+
+	const size_t mMaxWorkerQueueSize;
+	std::vector<unique_ptr<Worker>> mWorkers;
+};
+
+} // namespace legio::impl
+
+#endif
@@ -18,6 +18,9 @@
 
 #include "transport.hpp"
 #include "node.hpp"
+#include "random.hpp"
+
+#include <algorithm>
 
 namespace legio::impl {
 
@@ -40,23 +43,91 @@ void Transport::notify(const events::variant &event) {
 }
 
 void Transport::send(Identifier remoteId, binary payload) {
+	// The message is sealed instead of signed, the AEAD tag authenticates it
+	auto session = node()->graph->session(remoteId);
+	uint32_t sequence = mSendSequence++;
+	Identifier localId = node()->id();
+	binary ad = Message::AssociatedData(mType, sequence, localId, remoteId);
+	binary body = CipherBody::Seal(payload, *session, ad);
+	auto message = make_sealed_message(mType, sequence, std::move(body), localId, remoteId);
+	node()->routing->send(std::move(message));
+}
+
+std::vector<Identifier> Transport::sendMany(std::vector<Identifier> remoteIds,
+                                            binary payload) {
 	auto graph = node()->graph;
-	auto remoteState = graph->get(remoteId);
-	auto cipherBody = CipherBody::Encrypt(payload, graph->localEcdhPair(), remoteState.ecdhPublic);
-	auto message = make_message(mType, mSendSequence++, binary(cipherBody), node()->ecdsaPair,
-	                            EcdsaPublic(remoteId));
+
+	// Recipients without a known state can't be encrypted for, they are skipped
+	// The content suite must be supported by every recipient, by order of local preference
+	std::vector<Identifier> recipients;
+	std::vector<Identifier> skipped;
+	cipher_suites suites = LocalCipherSuites();
+	recipients.reserve(remoteIds.size());
+	for (auto &remoteId : remoteIds) {
+		auto remoteSuites = graph->remoteCipherSuites(remoteId);
+		if (!remoteSuites) {
+			skipped.push_back(std::move(remoteId));
+			continue;
+		}
+
+		suites.erase(std::remove_if(suites.begin(), suites.end(),
+		                            [&remoteSuites](CipherSuite suite) {
+			                            return std::find(remoteSuites->begin(), remoteSuites->end(),
+			                                             suite) == remoteSuites->end();
+		                            }),
+		             suites.end());
+		recipients.push_back(std::move(remoteId));
+	}
+
+	if (recipients.empty())
+		return skipped;
+
+	if (suites.empty()) {
+		// No suite in common, fall back to unicast
+		for (const auto &remoteId : recipients)
+			send(remoteId, payload);
+
+		return skipped;
+	}
+
+	// Encrypt the payload once with a random content key, then wrap the key for each recipient
+	binary contentKey(MulticastBody::ContentKeySize);
+	Prng().GenerateBlock(reinterpret_cast<CryptoPP::byte *>(contentKey.data()), contentKey.size());
+
+	auto encryption = AeadEncryption::Create(suites.front(), contentKey);
+	encryption->resynchronize();
+	MulticastBody body(encryption->suite(), encryption->iv(), encryption->encrypt(payload));
+	binary digest = body.digest();
+
+	uint32_t sequence = mSendSequence++;
+	Identifier localId = node()->id();
+	body.recipients.reserve(recipients.size());
+	for (const auto &remoteId : recipients) {
+		auto session = graph->session(remoteId);
+		binary ad = Message::AssociatedData(mType, sequence, localId, remoteId) + digest;
+		auto [iv, wrappedKey] = session->encrypt(contentKey, ad);
+		body.recipients.push_back({remoteId, session->localPublicKey(), session->suite(),
+		                           std::move(iv), std::move(wrappedKey)});
+	}
+
+	// Routing splits the recipients where their routes diverge
+	auto message = make_multicast_message(mType, sequence, binary(body), localId);
+	BufferPool::Instance().recycle(std::move(body.ciphertext)); // copied into the body
 	node()->routing->send(std::move(message));
+	return skipped;
 }
 
 void Transport::broadcast(binary payload) {
 	throw std::logic_error("Transport does not support broadcasting");
 }
 
+uint64_t Transport::decryptionFailures() const { return mDecryptionFailures.load(); }
+
 void Transport::incoming(message_ptr message, shared_ptr<Channel> from) {
-	Identifier remoteId(*message->source);
+	if (message->multicast)
+		return incomingMulticast(std::move(message));
 
-	if (!checkSequence(remoteId, message->sequence))
-		return;
+	Identifier remoteId(*message->source);
 
 	if (!message->destination)
 		return; // Do not accept broadcast
@@ -64,30 +135,83 @@ void Transport::incoming(message_ptr message, shared_ptr<Channel> from) {
 	// Direct send, decrypt message
 	CipherBody cipherBody(message->body);
 
-	auto localEcdhPair = node()->graph->localEcdhPair();
-	if (cipherBody.destination != localEcdhPair.publicKey())
+	auto graph = node()->graph;
+	if (!graph->isLocalEcdhPublicKey(cipherBody.destination))
 		return; // TODO: handle ECDH key rotation
 
+	binary ad;
+	if (message->sealed) {
+		// Without a signature, the source is authenticated by the ECDH key of its signed state
+		auto keys = graph->remoteEcdhPublicKeys(remoteId);
+		if (std::find(keys.begin(), keys.end(), cipherBody.source) == keys.end())
+			return;
+
+		ad = Message::AssociatedData(message->type, message->sequence, remoteId,
+		                             *message->destination);
+	}
+
 	// TODO: take new remote key into account
 
-	binary payload = cipherBody.decrypt(localEcdhPair);
+	binary payload;
+	try {
+		auto session = graph->session(cipherBody.source, cipherBody.suite);
+		payload = cipherBody.decrypt(*session, ad);
+
+	} catch (const std::exception &) {
+		// Anyone can send sealed messages, forged ones are dropped quietly
+		++mDecryptionFailures;
+		return;
+	}
+
+	// Check the sequence once authenticated so forged messages can't shadow legitimate ones
+	if (!checkSequence(remoteId, message->sequence))
+		return;
+
 	mReceiveCallback(std::move(remoteId), std::move(payload));
 }
 
-bool Transport::checkSequence(const Identifier &id, uint32_t sequence) {
-	std::lock_guard lock(mSequencesMutex);
-	auto it = mSequences.find(id);
-	if (it == mSequences.end()) {
-		mSequences.emplace(id, sequence);
-		return true;
+void Transport::incomingMulticast(message_ptr message) {
+	Identifier remoteId(*message->source);
+	Identifier localId = node()->id();
+
+	binary payload;
+	try {
+		MulticastBody body(message->body);
+		auto it = std::find_if(
+		    body.recipients.begin(), body.recipients.end(),
+		    [&localId](const auto &recipient) { return recipient.id == localId; });
+		if (it == body.recipients.end())
+			return;
+
+		// As for sealed messages, the source is authenticated by the ECDH key of its signed state
+		auto graph = node()->graph;
+		auto keys = graph->remoteEcdhPublicKeys(remoteId);
+		if (std::find(keys.begin(), keys.end(), it->source) == keys.end())
+			return;
+
+		auto session = graph->session(it->source, it->suite);
+		binary ad = Message::AssociatedData(message->type, message->sequence, remoteId, localId) +
+		            body.digest();
+		binary contentKey = std::move(it->wrappedKey);
+		session->decrypt(it->iv, contentKey, ad);
+		payload = body.decrypt(contentKey);
+
+	} catch (const std::exception &) {
+		// Multicast messages are sealed too, forged ones are dropped quietly
+		++mDecryptionFailures;
+		return;
 	}
 
-	if (compare_sequence(sequence, it->second) > 0) {
-		it->second = sequence;
-		return true;
-	}
+	if (!checkSequence(remoteId, message->sequence))
+		return;
 
-	return false;
+	mReceiveCallback(std::move(remoteId), std::move(payload));
+}
+
+bool Transport::checkSequence(const Identifier &id, uint32_t sequence) {
+	std::lock_guard lock(mSequencesMutex);
+	auto [it, inserted] = mSequences.emplace(id, SequenceWindow(sequence));
+	return inserted || it->second.accept(sequence);
 }
 
 } // namespace legio::impl
@@ -28,6 +28,7 @@
 #include <atomic>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace legio::impl {
 
@@ -42,19 +43,26 @@ public:
 	virtual void notify(const events::variant &event);
 
 	virtual void send(Identifier remoteId, binary payload);
+	// Returns the recipients which were skipped as their state is unknown
+	virtual std::vector<Identifier> sendMany(std::vector<Identifier> remoteIds, binary payload);
 	virtual void broadcast(binary payload);
 
+	// Incoming messages dropped because they could not be decrypted
+	uint64_t decryptionFailures() const;
+
 protected:
 	virtual void incoming(message_ptr message, shared_ptr<Channel> from);
+	void incomingMulticast(message_ptr message);
 	bool checkSequence(const Identifier &id, uint32_t sequence);
 
 	const Message::Type mType;
 	const ReceiveCallback mReceiveCallback;
 
 	std::atomic<uint32_t> mSendSequence;
+	std::atomic<uint64_t> mDecryptionFailures = 0;
 
 private:
-	std::unordered_map<Identifier, uint32_t, Identifier::hash> mSequences;
+	std::unordered_map<Identifier, SequenceWindow, Identifier::hash> mSequences;
 	std::mutex mSequencesMutex;
 };
 
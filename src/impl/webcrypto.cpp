@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifdef __EMSCRIPTEN__
+
+#include "webcrypto.hpp"
+
+#include <emscripten.h>
+
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+using legio::impl::PublicKey;
+
+// Without pthreads everything runs on the main thread, so no locking is needed
+std::unordered_map<int, PublicKey::VerifyCallback> PendingVerifications;
+int NextVerificationId = 0;
+
+} // namespace
+
+extern "C" {
+
+EMSCRIPTEN_KEEPALIVE void legio_webcrypto_verified(int id, int valid) {
+	auto it = PendingVerifications.find(id);
+	if (it == PendingVerifications.end())
+		return;
+
+	auto callback = std::move(it->second);
+	PendingVerifications.erase(it);
+	try {
+		callback(valid != 0);
+	} catch (const std::exception &e) {
+		std::cerr << "Verification callback failed: " << e.what() << std::endl;
+	}
+}
+
+} // extern "C"
+
+// Keys are imported once and kept as promises in a table, a handle of 0 means unavailable
+// Node.js exposes WebCrypto as globalThis.crypto since version 19, and as a module before
+EM_JS(int, webcrypto_import_p256, (const void *point, int size), {
+	try {
+		const subtle = (globalThis.crypto || require('crypto').webcrypto).subtle;
+		const keys = Module.legioWebCryptoKeys || (Module.legioWebCryptoKeys = {next: 0, map: new Map()});
+		const handle = ++keys.next;
+		const algorithm = {name: 'ECDSA', namedCurve: 'P-256'};
+		const raw = HEAPU8.slice(point, point + size);
+		keys.map.set(handle, subtle.importKey('raw', raw, algorithm, false, ['verify']));
+		return handle;
+	} catch (e) {
+		return 0;
+	}
+});
+
+EM_JS(void, webcrypto_verify, (int handle, int id, const void *message, int messageSize,
+                               const void *signature, int signatureSize), {
+	// Copy the data as the views are only valid during the call
+	const subtle = (globalThis.crypto || require('crypto').webcrypto).subtle;
+	const data = HEAPU8.slice(message, message + messageSize);
+	const sig = HEAPU8.slice(signature, signature + signatureSize);
+	const algorithm = {name: 'ECDSA', hash: 'SHA-256'};
+	Module.legioWebCryptoKeys.map.get(handle)
+		.then(key => subtle.verify(algorithm, key, sig, data))
+		.then(valid => _legio_webcrypto_verified(id, valid ? 1 : 0),
+		      () => _legio_webcrypto_verified(id, 0));
+});
+
+EM_JS(void, webcrypto_free_key, (int handle), { Module.legioWebCryptoKeys.map.delete(handle); });
+
+namespace legio::impl {
+
+WebCryptoEcdsaPublic::WebCryptoEcdsaPublic(binary_view key)
+    : mEcdsa(key), mHandle([this]() {
+	      // WebCrypto can't import compressed points
+	      binary point = mEcdsa.uncompressedPublicKey();
+	      return webcrypto_import_p256(point.data(), int(point.size()));
+      }()) {}
+
+WebCryptoEcdsaPublic::~WebCryptoEcdsaPublic() {
+	if (mHandle)
+		webcrypto_free_key(mHandle);
+}
+
+binary WebCryptoEcdsaPublic::publicKey() const { return mEcdsa.publicKey(); }
+
+bool WebCryptoEcdsaPublic::verify(const byte *message, size_t size, binary_view signature) const {
+	return mEcdsa.verify(message, size, signature);
+}
+
+void WebCryptoEcdsaPublic::verifyAsync(binary_view message, binary_view signature,
+                                       VerifyCallback callback) const {
+	if (!mHandle)
+		return PublicKey::verifyAsync(message, signature, std::move(callback));
+
+	int id = ++NextVerificationId;
+	PendingVerifications.emplace(id, std::move(callback));
+	webcrypto_verify(mHandle, id, message.data(), int(message.size()), signature.data(),
+	                 int(signature.size()));
+}
+
+} // namespace legio::impl
+
+#endif
@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef LEGIO_IMPL_WEBCRYPTO_H
+#define LEGIO_IMPL_WEBCRYPTO_H
+
+#ifdef __EMSCRIPTEN__
+
+#include "common.hpp"
+#include "ecdsa.hpp"
+#include "keys.hpp"
+
+namespace legio::impl {
+
+// ECDSA P-256 public key verifying asynchronously with WebCrypto, in browsers or Node.js
+// Synchronous verification, and asynchronous one if WebCrypto is unavailable, use Crypto++
+class WebCryptoEcdsaPublic final : public PublicKey {
+public:
+	WebCryptoEcdsaPublic(binary_view key);
+	WebCryptoEcdsaPublic(const WebCryptoEcdsaPublic &) = delete;
+	~WebCryptoEcdsaPublic();
+
+	KeyType type() const override { return KeyType::P256; }
+
+	binary publicKey() const override;
+
+	using PublicKey::verify;
+	bool verify(const byte *message, size_t size, binary_view signature) const override;
+	void verifyAsync(binary_view message, binary_view signature,
+	                 VerifyCallback callback) const override;
+
+private:
+	const EcdsaPublic mEcdsa; // validates and decompresses the key
+	const int mHandle;        // imported WebCrypto key, 0 if unavailable
+};
+
+} // namespace legio::impl
+
+#endif
+
+#endif
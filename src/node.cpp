@@ -43,10 +43,34 @@ void Node::send(binary id, binary message) {
 	return impl()->userTransport->send(impl::Identifier(std::move(id)), std::move(message));
 }
 
+std::vector<binary> Node::sendMany(std::vector<binary> ids, binary message) {
+	std::vector<impl::Identifier> remoteIds;
+	remoteIds.reserve(ids.size());
+	for (auto &id : ids)
+		remoteIds.emplace_back(std::move(id));
+
+	auto skipped = impl()->sendMany(std::move(remoteIds), std::move(message));
+
+	std::vector<binary> result;
+	result.reserve(skipped.size());
+	for (const auto &id : skipped)
+		result.emplace_back(id);
+
+	return result;
+}
+
 void Node::broadcast(binary message) {
 	return impl()->userTransport->broadcast(std::move(message));
 }
 
+std::future<void> Node::sendAsync(binary id, binary message) {
+	return impl()->sendAsync(impl::Identifier(std::move(id)), std::move(message));
+}
+
+std::future<void> Node::broadcastAsync(binary message) {
+	return impl()->broadcastAsync(std::move(message));
+}
+
 void Node::onMessage(std::function<void(binary id, binary message)> callback) {
 	std::lock_guard lock(impl()->messageCallbackMutex);
 	impl()->messageCallback = std::move(callback);
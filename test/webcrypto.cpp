@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2021 Paul-Louis Ageneau
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+// Run with Node.js: checks that WebCrypto verifies Crypto++ signatures and rejects tampered ones
+
+#include "impl/ecdsa.hpp"
+#include "impl/ed25519.hpp"
+#include "impl/keys.hpp"
+#include "impl/webcrypto.hpp"
+
+#include <emscripten.h>
+
+#include <iostream>
+#include <vector>
+
+using namespace legio;
+using namespace legio::impl;
+
+namespace {
+
+int Pending = 0;
+int Failures = 0;
+std::vector<shared_ptr<const PublicKey>> Keys; // kept until verifications complete
+
+void check(bool condition, const string &name) {
+	std::cout << (condition ? "PASS " : "FAIL ") << name << std::endl;
+	if (!condition)
+		++Failures;
+}
+
+void finish() {
+	if (--Pending > 0)
+		return;
+
+	std::cout << (Failures ? "Failed" : "Success") << std::endl;
+	emscripten_force_exit(Failures ? 1 : 0);
+}
+
+// The callback must be deferred for WebCrypto, asynchronous verification otherwise falls back to
+// Crypto++ and calls it before returning
+void expect(shared_ptr<const PublicKey> publicKey, const binary &message, const binary &signature,
+            bool expected, bool deferred, const string &name) {
+	++Pending;
+	Keys.push_back(publicKey);
+	auto returned = std::make_shared<bool>(false);
+	publicKey->verifyAsync(message, signature, [=](bool valid) {
+		check(valid == expected, name);
+		check(*returned == deferred, name + " (" + (deferred ? "deferred" : "immediate") + ")");
+		finish();
+	});
+	*returned = true;
+}
+
+binary tamper(binary bin) {
+	bin[bin.size() / 2] ^= byte(0x01);
+	return bin;
+}
+
+} // namespace
+
+int main() {
+	try {
+		const binary message = {byte('l'), byte('e'), byte('g'), byte('i'), byte('o')};
+
+		EcdsaPair ecdsaPair;
+		binary ecdsaSignature = ecdsaPair.sign(message);
+		binary ecdsaKey = ecdsaPair.publicPart()->publicKey();
+		auto webCryptoKey = PublicKey::Decode(ecdsaKey);
+		check(bool(std::dynamic_pointer_cast<const WebCryptoEcdsaPublic>(webCryptoKey)),
+		      "P-256 keys are decoded for WebCrypto");
+
+		++Pending; // until every verification is started
+		expect(webCryptoKey, message, ecdsaSignature, true, true, "P-256 valid signature");
+		expect(webCryptoKey, message, tamper(ecdsaSignature), false, true,
+		       "P-256 tampered signature");
+		expect(webCryptoKey, tamper(message), ecdsaSignature, false, true,
+		       "P-256 tampered message");
+		expect(std::make_shared<const WebCryptoEcdsaPublic>(ecdsaKey), message,
+		       binary(ecdsaSignature.begin(), ecdsaSignature.end() - 1), false, true,
+		       "P-256 truncated signature");
+
+		// Ed25519 is verified synchronously with Crypto++
+		Ed25519Pair ed25519Pair;
+		binary ed25519Signature = ed25519Pair.sign(message);
+		auto ed25519Key = PublicKey::Decode(ed25519Pair.publicPart()->publicKey());
+		expect(ed25519Key, message, ed25519Signature, true, false, "Ed25519 valid signature");
+		expect(ed25519Key, message, tamper(ed25519Signature), false, false,
+		       "Ed25519 tampered signature");
+
+		finish();
+
+	} catch (const std::exception &e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		emscripten_force_exit(1);
+	}
+
+	// Keep the runtime alive for the pending WebCrypto promises
+	emscripten_exit_with_live_runtime();
+	return 0;
+}